@@ -0,0 +1,223 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "fcntl.h"
+
+// kprof: 타이머 샘플링 프로파일 수집 후 kernel.sym 기준 flat profile 출력
+//   kprof [-t ticks]          : ticks 동안 시스템 전체 샘플링
+//   kprof [-t ticks] cmd ...  : cmd 실행이 끝날 때까지 샘플링
+
+#define KERNBASE  0x80000000
+#define NREAD     512     // profread 한 번에 읽을 샘플 수
+#define NUSERPID  64      // 유저 샘플을 pid별로 구분할 최대 개수
+
+struct sym {
+  uint addr;
+  char *name;
+  uint hits;
+};
+
+static struct sym *syms;
+static int nsym;
+
+static struct { int pid; uint hits; } upid[NUSERPID];
+static uint user_other, idle_hits, unknown_hits, total_hits;
+
+static void
+usage(void)
+{
+  printf(1, "usage: kprof [-t ticks] [cmd args...]\n");
+  exit();
+}
+
+static uint
+parse_hex(char *p)
+{
+  uint x = 0;
+  for(;; p++){
+    int v;
+    if(*p >= '0' && *p <= '9') v = *p - '0';
+    else if(*p >= 'a' && *p <= 'f') v = *p - 'a' + 10;
+    else if(*p >= 'A' && *p <= 'F') v = *p - 'A' + 10;
+    else break;
+    x = (x << 4) | (uint)v;
+  }
+  return x;
+}
+
+// kernel.sym ("addr name" 한 줄씩)을 읽어 주소순으로 정렬해 둔다.
+static int
+load_syms(char *path)
+{
+  struct stat st;
+  int fd, n, i, lines = 0;
+  char *text, *p;
+
+  if((fd = open(path, O_RDONLY)) < 0)
+    return -1;
+  if(fstat(fd, &st) < 0 || st.size == 0){
+    close(fd);
+    return -1;
+  }
+  text = malloc(st.size + 1);
+  for(n = 0; n < st.size; ){
+    i = read(fd, text + n, st.size - n);
+    if(i <= 0) break;
+    n += i;
+  }
+  close(fd);
+  text[n] = 0;
+
+  for(p = text; *p; p++)
+    if(*p == '\n') lines++;
+  syms = malloc(sizeof(struct sym) * (lines + 1));
+
+  for(p = text; *p; ){
+    char *line = p, *sp;
+    while(*p && *p != '\n') p++;
+    if(*p) *p++ = 0;
+    if((sp = strchr(line, ' ')) == 0)
+      continue;
+    *sp = 0;
+    uint a = parse_hex(line);
+    if(a < KERNBASE || sp[1] == 0 || sp[1] == '.')   // 섹션/파일 심볼 제외
+      continue;
+    syms[nsym].addr = a;
+    syms[nsym].name = sp + 1;
+    syms[nsym].hits = 0;
+    nsym++;
+  }
+
+  // 주소순 삽입 정렬 (심볼 수천 개 이내)
+  for(i = 1; i < nsym; i++){
+    struct sym t = syms[i];
+    int j = i - 1;
+    while(j >= 0 && syms[j].addr > t.addr){
+      syms[j+1] = syms[j];
+      j--;
+    }
+    syms[j+1] = t;
+  }
+  return nsym;
+}
+
+// addr 이하인 가장 큰 심볼 (이진 탐색)
+static struct sym*
+lookup(uint addr)
+{
+  int lo = 0, hi = nsym - 1, best = -1;
+  while(lo <= hi){
+    int mid = (lo + hi) / 2;
+    if(syms[mid].addr <= addr){
+      best = mid;
+      lo = mid + 1;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return best < 0 ? 0 : &syms[best];
+}
+
+static void
+account(struct profsample *s)
+{
+  int i;
+
+  total_hits++;
+  if(s->user){
+    for(i = 0; i < NUSERPID; i++){
+      if(upid[i].hits == 0) upid[i].pid = s->pid;
+      if(upid[i].pid == s->pid){
+        upid[i].hits++;
+        return;
+      }
+    }
+    user_other++;
+    return;
+  }
+  if(s->pid == -1){               // 스케줄러 유휴 루프
+    idle_hits++;
+    return;
+  }
+  struct sym *sy = lookup(s->eip);
+  if(sy)
+    sy->hits++;
+  else
+    unknown_hits++;
+}
+
+static void
+line(uint hits, char *what, int arg)
+{
+  uint pct10 = total_hits ? (hits * 1000 + total_hits / 2) / total_hits : 0;
+  printf(1, "%d\t%d.%d%%\t", hits, pct10 / 10, pct10 % 10);
+  if(arg >= 0)
+    printf(1, "%s %d\n", what, arg);
+  else
+    printf(1, "%s\n", what);
+}
+
+int
+main(int argc, char *argv[])
+{
+  int ticks = 100;
+  int i = 1, n, dropped;
+  static struct profsample buf[NREAD];
+
+  if(i < argc && !strcmp(argv[i], "-t")){
+    if(i + 1 >= argc) usage();
+    ticks = atoi(argv[i+1]);
+    if(ticks <= 0) usage();
+    i += 2;
+  }
+
+  if(load_syms("/kernel.sym") < 0)
+    printf(1, "kprof: kernel.sym not found, kernel samples unresolved\n");
+
+  profstart();
+  if(i < argc){
+    int pid = fork();
+    if(pid < 0){
+      printf(1, "kprof: fork failed\n");
+      profstop();
+      exit();
+    }
+    if(pid == 0){
+      exec(argv[i], argv + i);
+      printf(1, "kprof: exec %s failed\n", argv[i]);
+      exit();
+    }
+    wait();
+  } else {
+    sleep(ticks);
+  }
+  dropped = profstop();
+
+  while((n = profread(buf, NREAD)) > 0)
+    for(int k = 0; k < n; k++)
+      account(&buf[k]);
+
+  printf(1, "[kprof] %d samples (%d dropped)\n", total_hits, dropped);
+  printf(1, "samples\tpct\tsymbol\n");
+
+  // 히트 수 내림차순으로 커널 심볼 출력 (선택 정렬)
+  for(;;){
+    struct sym *best = 0;
+    for(int k = 0; k < nsym; k++)
+      if(syms[k].hits && (best == 0 || syms[k].hits > best->hits))
+        best = &syms[k];
+    if(best == 0) break;
+    line(best->hits, best->name, -1);
+    best->hits = 0;
+  }
+  for(int k = 0; k < NUSERPID; k++)
+    if(upid[k].hits)
+      line(upid[k].hits, "[user] pid", upid[k].pid);
+  if(user_other)
+    line(user_other, "[user] other", -1);
+  if(idle_hits)
+    line(idle_hits, "[idle]", -1);
+  if(unknown_hits)
+    line(unknown_hits, "[kernel] unknown", -1);
+  exit();
+}
@@ -0,0 +1,95 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "param.h"
+
+// mpstat: CPU별 usr/sys/irq/idle 비율을 구간(interval) 단위 변화량으로 출력
+
+static void
+usage(void)
+{
+  printf(1, "usage: mpstat [-i interval_ticks] [-c count]\n");
+  exit();
+}
+
+static uint
+total(struct cpustat *s)
+{
+  return s->user + s->kernel + s->intr + s->idle;
+}
+
+// 0~100 정수 퍼센트
+static int
+pct(uint part, uint whole)
+{
+  if(whole == 0) return 0;
+  return (int)((part * 100 + whole / 2) / whole);
+}
+
+static void
+print_row(char *name, struct cpustat *o, struct cpustat *n)
+{
+  uint dt = total(n) - total(o);
+  printf(1, "%s\t%d\t%d\t%d\t%d\t%d\t%d\n", name,
+         pct(n->user - o->user, dt),
+         pct(n->kernel - o->kernel, dt),
+         pct(n->intr - o->intr, dt),
+         pct(n->idle - o->idle, dt),
+         n->nintr - o->nintr,
+         n->ticks - o->ticks);
+}
+
+int
+main(int argc, char *argv[])
+{
+  int interval = 100;   // 기본: 100 ticks
+  int count = 5;        // 기본: 5회 출력
+  static struct cpustat prev[NCPU], cur[NCPU];
+  struct cpustat sum_o, sum_n;
+  char name[8];
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-i")) {
+      if (i + 1 >= argc) usage();
+      interval = atoi(argv[++i]);
+      if (interval <= 0) usage();
+    } else if (!strcmp(argv[i], "-c")) {
+      if (i + 1 >= argc) usage();
+      count = atoi(argv[++i]);
+      if (count <= 0) usage();
+    } else {
+      usage();
+    }
+  }
+
+  int ncpu = getcpustat(prev, NCPU);
+  if (ncpu < 0) {
+    printf(1, "mpstat: getcpustat failed\n");
+    exit();
+  }
+  if (ncpu > NCPU) ncpu = NCPU;
+
+  for (int r = 0; r < count; r++) {
+    sleep(interval);
+    getcpustat(cur, NCPU);
+
+    printf(1, "\nCPU\t%%usr\t%%sys\t%%irq\t%%idle\tintr\tticks\n");
+    memset(&sum_o, 0, sizeof(sum_o));
+    memset(&sum_n, 0, sizeof(sum_n));
+    for (int c = 0; c < ncpu; c++) {
+      name[0] = 'c'; name[1] = 'p'; name[2] = 'u';
+      name[3] = '0' + c; name[4] = 0;
+      print_row(name, &prev[c], &cur[c]);
+
+      sum_o.user += prev[c].user;   sum_n.user += cur[c].user;
+      sum_o.kernel += prev[c].kernel; sum_n.kernel += cur[c].kernel;
+      sum_o.intr += prev[c].intr;   sum_n.intr += cur[c].intr;
+      sum_o.idle += prev[c].idle;   sum_n.idle += cur[c].idle;
+      sum_o.nintr += prev[c].nintr; sum_n.nintr += cur[c].nintr;
+      sum_o.ticks += prev[c].ticks; sum_n.ticks += cur[c].ticks;
+      prev[c] = cur[c];
+    }
+    print_row("all", &sum_o, &sum_n);
+  }
+  exit();
+}
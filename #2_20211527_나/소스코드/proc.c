@@ -7,11 +7,21 @@
 #include "proc.h"
 #include "spinlock.h"
 
+// 프로세스 슬롯은 kalloc() 페이지에서 필요할 때 잘라 쓴다.
+// 사용 중인 슬롯(EMBRYO~ZOMBIE)만 list에 연결되므로 모든 스캔은
+// 빈 슬롯을 건너뛰지 않고 살아있는 프로세스 수만큼만 돈다.
+// 해제된 슬롯은 free 리스트로 돌아가며 페이지 자체는 반납하지 않는다
+// (p->parent 같은 오래된 포인터가 항상 유효한 메모리를 가리키도록).
 struct {
   struct spinlock lock;
-  struct proc proc[NPROC];
+  struct proc *list;     // 사용 중인 슬롯 (이중 연결)
+  struct proc *free;     // 빈 슬롯
+  int nproc;             // 사용 중인 슬롯 수
+  int nslot;             // 지금까지 만든 전체 슬롯 수
 } ptable;
 
+int maxproc = NPROC;     // 동시에 존재할 수 있는 최대 프로세스 수
+
 static struct proc *initproc;
 
 int nextpid = 1;
@@ -20,6 +30,45 @@ extern void trapret(void);
 
 static void wakeup1(void *chan);
 
+// 페이지 하나를 proc 슬롯들로 쪼개 free 리스트에 넣는다.
+// ptable.lock을 잡은 상태에서 호출.
+static int
+procpool_grow(void)
+{
+  char *page;
+  struct proc *p;
+  int i, n = PGSIZE / sizeof(struct proc);
+
+  if((page = kalloc()) == 0)
+    return -1;
+  memset(page, 0, PGSIZE);
+  for(i = 0; i < n; i++){
+    p = (struct proc*)page + i;
+    p->next = ptable.free;
+    ptable.free = p;
+  }
+  ptable.nslot += n;
+  return 0;
+}
+
+// 사용 중 리스트에서 p를 떼어 free 리스트로 돌려준다. ptable.lock 필요.
+static void
+procfree(struct proc *p)
+{
+  if(p->prev)
+    p->prev->next = p->next;
+  else
+    ptable.list = p->next;
+  if(p->next)
+    p->next->prev = p->prev;
+
+  p->state = UNUSED;
+  p->prev = 0;
+  p->next = ptable.free;
+  ptable.free = p;
+  ptable.nproc--;
+}
+
 void
 pinit(void)
 {
@@ -78,14 +127,22 @@ allocproc(void)
 
   acquire(&ptable.lock);
 
-  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++)
-    if(p->state == UNUSED)
-      goto found;
+  if(ptable.nproc >= maxproc ||
+     (ptable.free == 0 && procpool_grow() < 0)){
+    release(&ptable.lock);
+    return 0;
+  }
 
-  release(&ptable.lock);
-  return 0;
+  p = ptable.free;
+  ptable.free = p->next;
+  memset(p, 0, sizeof(*p));
+
+  p->next = ptable.list;
+  if(ptable.list)
+    ptable.list->prev = p;
+  ptable.list = p;
+  ptable.nproc++;
 
-found:
   p->state = EMBRYO;
   p->pid = nextpid++;
 
@@ -93,7 +150,9 @@ found:
 
   // Allocate kernel stack.
   if((p->kstack = kalloc()) == 0){
-    p->state = UNUSED;
+    acquire(&ptable.lock);
+    procfree(p);
+    release(&ptable.lock);
     return 0;
   }
   sp = p->kstack + KSTACKSIZE;
@@ -117,6 +176,10 @@ found:
   p->pass      = 0;
   p->ticks     = 0;
   p->end_ticks = -1;
+  p->budget    = 0;     // CPU 예약 없음
+  p->period    = 0;
+  p->budget_used = 0;
+  p->period_end  = 0;
 
   return p;
 }
@@ -199,7 +262,9 @@ fork(void)
   if((np->pgdir = copyuvm(curproc->pgdir, curproc->sz)) == 0){
     kfree(np->kstack);
     np->kstack = 0;
-    np->state = UNUSED;
+    acquire(&ptable.lock);
+    procfree(np);
+    release(&ptable.lock);
     return -1;
   }
   np->sz = curproc->sz;
@@ -216,6 +281,13 @@ fork(void)
 
   safestrcpy(np->name, curproc->name, sizeof(curproc->name));
 
+  // CPU 예약은 자식에게 상속 (throttle된 백그라운드 작업의 자식도 같은 제한)
+  if(curproc->budget > 0){
+    np->budget = curproc->budget;
+    np->period = curproc->period;
+    np->period_end = ticks + np->period;
+  }
+
   pid = np->pid;
 
   acquire(&ptable.lock);
@@ -263,7 +335,7 @@ exit(void)
   wakeup1(curproc->parent);
 
   // Pass abandoned children to init.
-  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
+  for(p = ptable.list; p; p = p->next){
     if(p->parent == curproc){
       p->parent = initproc;
       if(p->state == ZOMBIE)
@@ -295,7 +367,7 @@ wait(void)
   for(;;){
     // Scan through table looking for exited children.
     havekids = 0;
-    for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
+    for(p = ptable.list; p; p = p->next){
       if(p->parent != curproc)
         continue;
       havekids = 1;
@@ -309,7 +381,7 @@ wait(void)
         p->parent = 0;
         p->name[0] = 0;
         p->killed = 0;
-        p->state = UNUSED;
+        procfree(p);
         release(&ptable.lock);
         return pid;
       }
@@ -351,7 +423,7 @@ scheduler(void)
 
     // ---------- 실행할 프로세스 선택 ----------
     best = 0;
-    for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
+    for(p = ptable.list; p; p = p->next){
       if(p->state != RUNNABLE) continue;
       if(best == 0 ||
          p->pass < best->pass ||
@@ -413,6 +485,27 @@ yield(void)
   release(&ptable.lock);
 }
 
+// CPU 예약 예산을 다 쓴 현재 프로세스를 종료하는 대신
+// 현재 주기가 끝날 때까지 재웠다가(throttle) 다음 주기에 다시 들여보낸다.
+// 매 tick wakeup(&ticks)로 깨어나 경계를 확인한다(sys_sleep과 같은 방식).
+void
+budget_park(void)
+{
+  struct proc *p = myproc();
+
+  if(stride_debug_on(p)){
+    cprintf("Process %d throttled (%d/%d ticks, resume at %d)\n",
+            p->pid, p->budget_used, p->budget, p->period_end);
+  }
+
+  acquire(&tickslock);
+  while(ticks < p->period_end && !p->killed)
+    sleep(&ticks, &tickslock);
+  p->budget_used = 0;
+  p->period_end  = ticks + p->period;
+  release(&tickslock);
+}
+
 // A fork child's very first scheduling by scheduler()
 // will swtch here.  "Return" to user space.
 void
@@ -481,7 +574,7 @@ wakeup1(void *chan)
 {
   struct proc *p;
 
-  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+  for(p = ptable.list; p; p = p->next)
     if(p->state == SLEEPING && p->chan == chan)
       p->state = RUNNABLE;
 }
@@ -504,7 +597,7 @@ kill(int pid)
   struct proc *p;
 
   acquire(&ptable.lock);
-  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
+  for(p = ptable.list; p; p = p->next){
     if(p->pid == pid){
       p->killed = 1;
       // Wake process from sleep if necessary.
@@ -538,7 +631,7 @@ procdump(void)
   char *state;
   uint pc[10];
 
-  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
+  for(p = ptable.list; p; p = p->next){
     if(p->state == UNUSED)
       continue;
     if(p->state >= 0 && p->state < NELEM(states) && states[p->state])
@@ -8,6 +8,9 @@ struct cpu {
   int ncli;                    // Depth of pushcli nesting.
   int intena;                  // Were interrupts enabled before pushcli?
   struct proc *proc;           // The process running on this cpu or null
+  struct cpustat stat;         // 사용률 회계 (trap.c의 cpu_account)
+  uint last_tsc;               // 직전 로컬 타이머 인터럽트 시점의 TSC (하위 32비트)
+  uint intr_cyc;               // 직전 타이머 이후 인터럽트 핸들러에서 보낸 사이클
 };
 
 extern struct cpu cpus[NCPU];
@@ -54,6 +57,12 @@ struct proc {
   uint pass;				   // 기본값 : 0 (setticket으로 설정)
   int ticks;				   // 기본값 : 0
   int end_ticks;			   // 기본값 : -1 (양수인 경우 ticks 변수가 end_ticks값이 되면 프로세스 종료)
+  int budget;				   // 기본값 : 0 (주기당 허용 tick, 0이면 예약 없음. setreserve로 설정)
+  int period;				   // 기본값 : 0 (예약 주기, tick 단위)
+  int budget_used;			   // 현재 주기에서 사용한 tick
+  uint period_end;			   // 현재 주기가 끝나는 전역 ticks 값
+  struct proc *next;		   // ptable.list / ptable.free 연결
+  struct proc *prev;		   // ptable.list 이전 슬롯 (free 리스트에서는 0)
 };
 
 // Process memory is laid out contiguously, low addresses first:
@@ -104,6 +104,11 @@ extern int sys_wait(void);
 extern int sys_write(void);
 extern int sys_uptime(void);
 extern int sys_settickets(void);
+extern int sys_getcpustat(void);
+extern int sys_profstart(void);
+extern int sys_profstop(void);
+extern int sys_profread(void);
+extern int sys_setreserve(void);
 
 static int (*syscalls[])(void) = {
 [SYS_fork]    sys_fork,
@@ -128,6 +133,11 @@ static int (*syscalls[])(void) = {
 [SYS_mkdir]   sys_mkdir,
 [SYS_close]   sys_close,
 [SYS_settickets]  sys_settickets,
+[SYS_getcpustat]  sys_getcpustat,
+[SYS_profstart]   sys_profstart,
+[SYS_profstop]    sys_profstop,
+[SYS_profread]    sys_profread,
+[SYS_setreserve]  sys_setreserve,
 };
 
 void
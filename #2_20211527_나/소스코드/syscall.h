@@ -21,3 +21,8 @@
 #define SYS_mkdir  20
 #define SYS_close  21
 #define SYS_settickets 22
+#define SYS_getcpustat 23
+#define SYS_profstart  24
+#define SYS_profstop   25
+#define SYS_profread   26
+#define SYS_setreserve 27
@@ -10,9 +10,15 @@
 
 extern struct {
 	struct spinlock lock;
-	struct proc proc[NPROC];
+	struct proc *list;
+	struct proc *free;
+	int nproc;
+	int nslot;
 } ptable;
 
+extern int prof_control(int on);
+extern int prof_read(uint dst, int max);
+
 int
 sys_fork(void)
 {
@@ -119,3 +125,80 @@ sys_settickets(void)
 
   return 0;
 }
+
+// setreserve: 주기(period tick)마다 최대 budget tick만 CPU를 쓰도록 예약
+// 예산을 다 쓰면 종료되지 않고 다음 주기 경계까지 대기한다. budget <= 0이면 해제.
+int
+sys_setreserve(void)
+{
+  int budget, period;
+  if (argint(0, &budget) < 0) return -1;
+  if (argint(1, &period) < 0) return -1;
+
+  if (budget > 0 && period < budget)   // 1 <= budget <= period
+    return -1;
+
+  struct proc *p = myproc();
+
+  acquire(&ptable.lock);
+  if (budget <= 0) {
+    p->budget = 0;
+    p->period = 0;
+  } else {
+    p->budget = budget;
+    p->period = period;
+    p->budget_used = 0;
+    p->period_end  = ticks + period;
+  }
+  release(&ptable.lock);
+
+  return 0;
+}
+
+// getcpustat: CPU별 사용률 스냅샷을 buf[0..max-1]에 채우고 CPU 개수를 반환.
+// 각 CPU 자신만 갱신하는 카운터이므로 락 없이 읽는다(통계용).
+int
+sys_getcpustat(void)
+{
+  char *ubuf;
+  int max, i;
+
+  if (argint(1, &max) < 0) return -1;
+  if (max <= 0) return -1;
+  if (max > ncpu) max = ncpu;
+  if (argptr(0, &ubuf, sizeof(struct cpustat) * max) < 0) return -1;
+
+  for (i = 0; i < max; i++)
+    ((struct cpustat*)ubuf)[i] = cpus[i].stat;
+  return ncpu;
+}
+
+// profstart / profstop: 타이머 샘플링 프로파일러 켜기/끄기
+// profstop은 버퍼 부족으로 버려진 샘플 수를 반환한다.
+int
+sys_profstart(void)
+{
+  return prof_control(1);
+}
+
+int
+sys_profstop(void)
+{
+  return prof_control(0);
+}
+
+// profread: 모인 샘플을 buf에 최대 max개 옮기고 개수를 반환 (0이면 비어 있음)
+int
+sys_profread(void)
+{
+  char *ubuf;
+  int max;
+
+  if (argint(1, &max) < 0) return -1;
+  if (max <= 0) return -1;
+  // 크기 계산이 32비트에서 넘치지 않도록 주소공간에 들어갈 수 있는 개수로 먼저 거른다
+  if (max > myproc()->sz / sizeof(struct profsample)) return -1;
+  if (argptr(0, &ubuf, sizeof(struct profsample) * max) < 0) return -1;
+
+  return prof_read((uint)ubuf, max);
+}
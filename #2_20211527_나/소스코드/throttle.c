@@ -0,0 +1,34 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+
+// throttle: CPU 예약을 건 상태로 명령 실행
+//   throttle budget period cmd [args...]
+//   period tick마다 최대 budget tick만 CPU를 사용 (초과 시 다음 주기까지 대기)
+
+static void
+usage(void)
+{
+  printf(1, "usage: throttle budget period cmd [args...]\n");
+  exit();
+}
+
+int
+main(int argc, char *argv[])
+{
+  if (argc < 4) usage();
+
+  int budget = atoi(argv[1]);
+  int period = atoi(argv[2]);
+  if (budget <= 0 || period < budget) usage();
+
+  if (setreserve(budget, period) < 0) {
+    printf(1, "throttle: setreserve failed\n");
+    exit();
+  }
+
+  // 예약은 exec 후에도 유지된다
+  exec(argv[3], argv + 3);
+  printf(1, "throttle: exec %s failed\n", argv[3]);
+  exit();
+}
@@ -16,9 +16,146 @@ uint ticks;
 
 extern struct {
   struct spinlock lock;
-  struct proc proc[NPROC];
+  struct proc *list;
+  struct proc *free;
+  int nproc;
+  int nslot;
 } ptable;
 
+void budget_park(void);   // proc.c
+
+// TSC 하위 32비트. 한 틱 안의 차이만 쓰므로 wrap 되어도 무방하다.
+static inline uint
+rdtsc32(void)
+{
+  uint lo, hi;
+  asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+  return lo;
+}
+
+// 로컬 타이머 인터럽트마다 호출 (인터럽트 off 상태).
+// 직전 틱 이후 구간(100 단위)을 인터럽트 핸들러 몫과
+// 인터럽트 당시 상태(user/kernel/idle) 몫으로 나눠 누적한다.
+static void
+cpu_account(struct trapframe *tf)
+{
+  struct cpu *c = mycpu();
+  uint now = rdtsc32();
+  uint unit = (now - c->last_tsc) / 100;
+  uint ishare = 0;
+
+  if(c->last_tsc != 0 && unit != 0){
+    ishare = c->intr_cyc / unit;
+    if(ishare > 100) ishare = 100;
+  }
+  c->last_tsc = now;
+  c->intr_cyc = 0;
+
+  c->stat.ticks++;
+  c->stat.intr += ishare;
+  if((tf->cs&3) == DPL_USER)
+    c->stat.user += 100 - ishare;
+  else if(c->proc == 0)
+    c->stat.idle += 100 - ishare;
+  else
+    c->stat.kernel += 100 - ishare;
+}
+
+// ---- 샘플링 프로파일러 ----
+// 켜져 있는 동안 로컬 타이머 인터럽트마다 CPU별 링 버퍼에 eip/pid를 기록한다.
+// 버퍼가 가득 차면 profread로 비울 때까지 샘플을 버리고 dropped만 센다.
+// head/tail은 계속 증가하는 카운터이고 tail - head가 쌓인 샘플 수다.
+#define PROF_NSAMPLE 2048   // CPU당 샘플 버퍼 크기 (2의 거듭제곱)
+
+static struct {
+  struct spinlock lock;
+  struct profsample buf[PROF_NSAMPLE];
+  uint head, tail;
+  uint dropped;
+} prof[NCPU];
+static volatile int prof_on;
+
+static void
+prof_sample(struct trapframe *tf)
+{
+  struct cpu *c = mycpu();
+  int id = c - cpus;
+
+  acquire(&prof[id].lock);
+  if(prof[id].tail - prof[id].head < PROF_NSAMPLE){
+    struct profsample *s = &prof[id].buf[prof[id].tail++ % PROF_NSAMPLE];
+    s->eip  = tf->eip;
+    s->pid  = c->proc ? c->proc->pid : -1;
+    s->cpu  = id;
+    s->user = (tf->cs&3) == DPL_USER;
+  } else {
+    prof[id].dropped++;
+  }
+  release(&prof[id].lock);
+}
+
+// on=1: 버퍼를 비우고 샘플링 시작, on=0: 중지.
+// 중지할 때는 버퍼 부족으로 버린 샘플 수를 반환한다.
+int
+prof_control(int on)
+{
+  int i;
+  uint dropped = 0;
+
+  if(on){
+    prof_on = 0;
+    for(i = 0; i < ncpu; i++){
+      acquire(&prof[i].lock);
+      prof[i].head = prof[i].tail = 0;
+      prof[i].dropped = 0;
+      release(&prof[i].lock);
+    }
+    prof_on = 1;
+    return 0;
+  }
+
+  prof_on = 0;
+  for(i = 0; i < ncpu; i++)
+    dropped += prof[i].dropped;
+  return dropped;
+}
+
+// 모인 샘플을 최대 max개 유저 주소 dst로 옮기고(옮긴 것은 버퍼에서 제거) 개수를 반환.
+// 락(인터럽트 off) 구간에서는 커널 페이지로 한 조각만 떼어 내고, copyout은 락을 놓고 한다.
+int
+prof_read(uint dst, int max)
+{
+  struct profsample *kbuf;
+  int chunk = PGSIZE / sizeof(struct profsample);
+  int i, j, k, got = 0;
+
+  if((kbuf = (struct profsample*)kalloc()) == 0)
+    return -1;
+  for(i = 0; i < ncpu && got < max; ){
+    acquire(&prof[i].lock);
+    k = prof[i].tail - prof[i].head;
+    if(k > max - got)
+      k = max - got;
+    if(k > chunk)
+      k = chunk;
+    for(j = 0; j < k; j++)
+      kbuf[j] = prof[i].buf[prof[i].head++ % PROF_NSAMPLE];
+    release(&prof[i].lock);
+    if(k == 0){
+      i++;
+      continue;
+    }
+    if(copyout(myproc()->pgdir, dst + got * sizeof(struct profsample),
+               kbuf, k * sizeof(struct profsample)) < 0){
+      kfree((char*)kbuf);
+      return -1;
+    }
+    got += k;
+  }
+  kfree((char*)kbuf);
+  return got;
+}
+
 void
 tvinit(void)
 {
@@ -29,6 +166,8 @@ tvinit(void)
   SETGATE(idt[T_SYSCALL], 1, SEG_KCODE<<3, vectors[T_SYSCALL], DPL_USER);
 
   initlock(&tickslock, "time");
+  for(i = 0; i < NCPU; i++)
+    initlock(&prof[i].lock, "prof");
 }
 
 void
@@ -51,8 +190,13 @@ trap(struct trapframe *tf)
     return;
   }
 
+  uint t0 = rdtsc32();
+
   switch(tf->trapno){
   case T_IRQ0 + IRQ_TIMER:
+    cpu_account(tf);
+    if(prof_on)
+      prof_sample(tf);
     if(cpuid() == 0){
       acquire(&tickslock);
       ticks++;
@@ -99,6 +243,14 @@ trap(struct trapframe *tf)
     myproc()->killed = 1;
   }
 
+  // 디바이스 인터럽트 처리 시간/횟수 (다음 로컬 틱에서 intr 몫으로 환산)
+  // 로컬 타이머는 빼야 nintr이 틱 수로, intr_cyc가 cpu_account/prof_sample 비용으로 부풀지 않는다
+  if(tf->trapno >= T_IRQ0 && tf->trapno <= T_IRQ0 + IRQ_SPURIOUS &&
+     tf->trapno != T_IRQ0 + IRQ_TIMER){
+    mycpu()->stat.nintr++;
+    mycpu()->intr_cyc += rdtsc32() - t0;
+  }
+
   // Force process exit if it has been killed and is in user space.
   // (If it is still executing in the kernel, let it keep running
   // until it gets to the regular system call return.)
@@ -129,7 +281,7 @@ trap(struct trapframe *tf)
 
   int need_rebase = 0;
   struct proc *q;
-  for (q = ptable.proc; q < &ptable.proc[NPROC]; q++) {
+  for (q = ptable.list; q; q = q->next) {
     int considered = (q->state == RUNNABLE) || (q == cp);
     if (!considered) continue;
     if (q->pass > PASS_MAX) { need_rebase = 1; break; }
@@ -137,7 +289,7 @@ trap(struct trapframe *tf)
 
   if (need_rebase) {
     uint min_pass = 0xffffffffu;
-    for (q = ptable.proc; q < &ptable.proc[NPROC]; q++) {
+    for (q = ptable.list; q; q = q->next) {
       int considered = (q->state == RUNNABLE) || (q == cp);
       if (!considered) continue;
       if (q->pass < min_pass) min_pass = q->pass;
@@ -145,7 +297,7 @@ trap(struct trapframe *tf)
 
     //cprintf("\nRebase Process Start\n\n");
 
-    for (q = ptable.proc; q < &ptable.proc[NPROC]; q++) {
+    for (q = ptable.list; q; q = q->next) {
       int considered = (q->state == RUNNABLE) || (q == cp);
       if (!considered) continue;
 
@@ -171,7 +323,20 @@ trap(struct trapframe *tf)
     	exit();
   	}
 
-    yield();
+    // CPU 예약: 주기당 budget tick을 다 쓰면 종료 대신 다음 주기까지 대기.
+    // 커널 안(슬립락 보유 가능)에서는 재우지 않고 유저 모드 tick까지 미룬다.
+    if (cp->budget > 0) {
+      if (ticks >= cp->period_end) {
+        cp->budget_used = 0;
+        cp->period_end  = ticks + cp->period;
+      }
+      cp->budget_used++;
+    }
+
+    if (cp->budget > 0 && cp->budget_used >= cp->budget && (tf->cs&3) == DPL_USER)
+      budget_park();
+    else
+      yield();
   }
 
   // Check if the process has been killed since we yielded
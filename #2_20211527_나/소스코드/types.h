@@ -0,0 +1,23 @@
+typedef unsigned int   uint;
+typedef unsigned short ushort;
+typedef unsigned char  uchar;
+typedef uint pde_t;
+
+// CPU별 사용률 (getcpustat / mpstat)
+// user/kernel/intr/idle은 1/100 tick 단위이며, 로컬 타이머 인터럽트마다 합계가 100씩 증가한다.
+struct cpustat {
+  uint user;      // 유저 모드
+  uint kernel;    // 커널 모드 (프로세스 문맥)
+  uint intr;      // 디바이스 인터럽트 핸들러
+  uint idle;      // 스케줄러 유휴 루프 (c->proc == 0)
+  uint nintr;     // 처리한 디바이스 인터럽트 수 (로컬 타이머 제외)
+  uint ticks;     // 이 CPU가 받은 로컬 타이머 인터럽트 수
+};
+
+// 타이머 인터럽트 샘플 (profstart / profread / kprof)
+struct profsample {
+  uint   eip;     // 인터럽트된 tf->eip
+  int    pid;     // 실행 중이던 프로세스 (없으면 -1)
+  ushort cpu;
+  ushort user;    // 1: 유저 모드에서 인터럽트됨
+};
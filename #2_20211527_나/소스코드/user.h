@@ -1,5 +1,7 @@
 struct stat;
 struct rtcdate;
+struct cpustat;
+struct profsample;
 
 // system calls
 int fork(void);
@@ -24,6 +26,11 @@ char* sbrk(int);
 int sleep(int);
 int uptime(void);
 int settickets(int tickets, int end_ticks);
+int getcpustat(struct cpustat *buf, int max);
+int profstart(void);
+int profstop(void);
+int profread(struct profsample *buf, int max);
+int setreserve(int budget, int period);
 
 
 // ulib.c
@@ -1,4 +1,14 @@
 struct buf;
+struct buddyinfo;
+struct physframe_info;
+struct pfquery;
+struct kmem_cache;
+struct slabinfo;
+struct stlbstat;
+struct vtopent;
+struct rmapcur;
+struct rmapent;
+struct iptstat;
 struct context;
 struct file;
 struct inode;
@@ -9,6 +19,7 @@ struct spinlock;
 struct sleeplock;
 struct stat;
 struct superblock;
+struct syscallstat;
 
 // bio.c
 void            binit(void);
@@ -65,10 +76,32 @@ void            ioapicinit(void);
 
 // kalloc.c
 char*           kalloc(void);
+char*           kalloc_type(int, int);
+char*           kzalloc(void);
+char*           kzalloc_type(int, int);
+void            kzero_refill(void);
 void            kfree(char*);
+char*           kalloc_order(int, int, int);
+void            kfree_order(char*, int);
+void            kmem_buddyinfo(struct buddyinfo*);
+int             pf_export(struct physframe_info*, uint, int);
+int             pf_query(struct pfquery*, struct physframe_info*, int);
+int             pf_owner(uint);
+void            pf_usage(int, uint*);
+uint            pf_mapget(uint);
+void            pf_mapinc(uint);
+uint            pf_mapdec(uint);
+void            kmem_typeinfo(uint*);
 void            kinit1(void*, void*);
 void            kinit2(void*, void*);
 
+// slab.c
+struct kmem_cache* kmem_cache_create(char*, uint, int);
+void*           kmem_cache_alloc(struct kmem_cache*);
+void            kmem_cache_free(struct kmem_cache*, void*);
+int             kmem_cache_info(struct slabinfo*, int);
+int             kmem_cache_reap(void);
+
 // kbd.c
 void            kbdintr(void);
 
@@ -96,6 +129,7 @@ void            picenable(int);
 void            picinit(void);
 
 // pipe.c
+void            pipeinit(void);
 int             pipealloc(struct file**, struct file**);
 void            pipeclose(struct pipe*, int);
 int             piperead(struct pipe*, char*, int);
@@ -155,6 +189,8 @@ int             argstr(int, char**);
 int             fetchint(uint, int*);
 int             fetchstr(uint, char**);
 void            syscall(void);
+int             scstat_read(struct syscallstat*, int);
+void            scstat_reset(int);
 
 // timer.c
 void            timerinit(void);
@@ -174,6 +210,7 @@ void            uartputc(int);
 void            seginit(void);
 void            kvmalloc(void);
 pde_t*          setupkvm(void);
+pde_t*          setupkvm_owner(int);
 char*           uva2ka(pde_t*, char*);
 int             allocuvm(pde_t*, uint, uint);
 int             deallocuvm(pde_t*, uint, uint);
@@ -186,27 +223,33 @@ void            switchkvm(void);
 int             copyout(pde_t*, uint, void*, uint);
 void            clearpteu(pde_t *pgdir, char *uva);
 
-extern struct physframe_info pf_info[];
-extern const int PFN_TABLE_SIZE;
+extern uint pf_nframes;
 struct vref; 
 
 int sw_vtop(pde_t *pgdir, const void *va, uint *pa_out, uint *flags_out);
+int vtop_range(pde_t*, uint, uint, struct vtopent*, int, int, uint*);
 void ipt_init(void);
 void ipt_insert(uint pfn, int pid, uint va_page, uint flags);
 int  ipt_remove(int pid, uint va_page, uint pfn);
 int  ipt_query(uint pfn, struct vref *kbuf, int max); // 커널버퍼에 채워줌
+int  ipt_rmap(struct rmapcur *c, struct rmapent *out, int max);
+void ipt_stats(struct iptstat *out);
 void stlb_init(void);
 int  stlb_lookup(int pid, uint va_page, uint *pa_page, uint *flags);
 void stlb_fill(int pid, uint va_page, uint pa_page, uint flags);
 void stlb_stats(uint *hits, uint *misses);
+int  stlb_cpustats(struct stlbstat *out, int max);
+int  stlb_pidstats(int pid, struct stlbstat *out);
 
 void ipt_purge_pid(int pid);
 int  ipt_update_flags(int pid, uint va_page, uint pfn, uint newflags);
 void stlb_invalidate_va(int pid, uint va_page);
 void stlb_update_flags(int pid, uint va_page, uint newflags);
 void stlb_purge_pid(int pid);
+void stlb_invalidate_range(int pid, uint va, uint len);
 
 int cow_fault(pde_t *pgdir, uint va);
+int lazy_fault(pde_t *pgdir, uint va, uint sz, int write);
 
 void pf_mark_ready(void);
 extern int pf_ready;
@@ -49,8 +49,13 @@ exec(char *path, char **argv)
       goto bad;
     if(ph.vaddr + ph.memsz < ph.vaddr)
       goto bad;
-    if((sz = allocuvm(pgdir, sz, ph.vaddr + ph.memsz)) == 0)
+    // 파일 내용이 있는 페이지까지만 할당하고, bss(memsz - filesz)는 sz만 넓혀
+    // 둔다 → 첫 접근 때 lazy_fault (읽기면 공유 0 페이지)
+    if(ph.vaddr + ph.filesz > sz &&
+       allocuvm(pgdir, sz, ph.vaddr + ph.filesz) == 0)
       goto bad;
+    if(ph.vaddr + ph.memsz > sz)
+      sz = ph.vaddr + ph.memsz;
     if(ph.vaddr % PGSIZE != 0)
       goto bad;
     if(loaduvm(pgdir, (char*)ph.vaddr, ip, ph.off, ph.filesz) < 0)
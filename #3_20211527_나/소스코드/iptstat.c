@@ -0,0 +1,52 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+
+// iptstat: IPT 해시 버킷 점유율, 체인 길이 분포, 엔트리 최대치, 락 대기 시간 출력
+//   해시 함수/버킷 수를 조정할 때 근거로 쓴다.
+
+static char *bins[IPT_HIST] = { "0", "1", "2", "3", "4-7", "8-15", "16-31", "32+" };
+
+static void
+hist(char *title, uint *h, uint total)
+{
+  printf(1, "%s\n  len\tbuckets\tpct\n", title);
+  for(int i = 0; i < IPT_HIST; i++)
+    printf(1, "  %s\t%d\t%d%%\n", bins[i], h[i], total ? h[i] * 100 / total : 0);
+}
+
+int
+main(int argc, char *argv[])
+{
+  struct iptstat st;
+
+  if(argc != 1){
+    printf(1, "usage: iptstat\n");
+    exit();
+  }
+  if(iptstat(&st) < 0){
+    printf(1, "iptstat: syscall failed\n");
+    exit();
+  }
+
+  printf(1, "[ipt] entries=%d peak=%d drops=%d\n", st.nent, st.hiwat, st.drops);
+  printf(1, "[ipt] pfn buckets: %d used of %d (%d%%), max chain %d\n",
+         st.used, st.nbuckets, st.nbuckets ? st.used * 100 / st.nbuckets : 0,
+         st.maxchain);
+  if(st.used)
+    printf(1, "[ipt] avg chain (used buckets) = %d.%d\n",
+           st.nent / st.used, (st.nent % st.used) * 10 / st.used);
+  hist("pfn bucket chain lengths:", st.hist, st.nbuckets);
+  hist("pid bucket chain lengths:", st.pidhist, st.npidbuckets);
+
+  printf(1, "[lock] acquires=%d contended=%d (%d%%)\n", st.lkacq, st.lkcont,
+         st.lkacq ? st.lkcont * 100 / st.lkacq : 0);
+  printf(1, "[lock] wait cycles total=");
+  print_u64(1, st.lkwait);
+  printf(1, " avg=");
+  print_u64(1, udiv64(st.lkwait, st.lkacq));
+  printf(1, " max=");
+  print_u64(1, st.lkmax);
+  printf(1, "\n");
+  exit();
+}
@@ -1,6 +1,10 @@
 // Physical memory allocator, intended to allocate
 // memory for user processes, kernel stacks, page table pages,
 // and pipe buffers. Allocates 4096-byte pages.
+//
+// 구조: 이진 버디 할당기(order 0..MAXORDER, 2^order 페이지 연속 블록) 위에
+//       CPU별 order-0 매거진과 0 페이지 풀이 얹혀 있다.
+//       kalloc()/kfree()는 1페이지, kalloc_order()/kfree_order()는 연속 블록.
 
 #include "types.h"
 #include "defs.h"
@@ -14,28 +18,179 @@
 extern int pf_ready; 
 
 // ---- 전역 프레임 추적 테이블 ----
-#define PFNNUM 60000                // 테이블 크기
-const int PFN_TABLE_SIZE = PFNNUM;  // 다른 파일에서 extern으로 참조할 변수 이름
-struct physframe_info pf_info[PFNNUM];
+// PHYSTOP 기준 프레임 수만큼 kinit1()이 커널 끝 바로 뒤에서 잘라 쓴다
+// (프레임당 pframe 12바이트 + pf_mapcnt 4바이트 + buddy_order 1바이트).
+//   info: [7:0] 플래그(PF_*), [15:8] 용도(PF_T_*), [31:16] 소유자 pid+1 (0: 커널/없음,
+//         PF_OWNER_OVF: 16비트에 안 들어가는 pid → pid -2로 보고)
+//   tick: 할당 시각 (ticks, 32비트 그대로: 16비트면 100Hz에서 11분 만에 돈다)
+//   gen : 마지막으로 바뀐 세대 (pf_epoch, pfquery의 증분 덤프용)
+// 할당/해제하는 CPU만 그 프레임을 만지므로 락 없이 워드 단위 원자적 store로 갱신하고,
+// 읽는 쪽(pf_export)은 info를 먼저 읽어 찢어진 값 대신 약간 지난 값을 볼 뿐이다.
+#define PF_ALLOC    0x0001
+#define PF_OWNER_OVF 0xFFFF
+
+struct pframe {
+  uint info;
+  uint tick;
+  uint gen;
+};
+
+static struct pframe *pftab;
+uint pf_nframes;                    // 테이블 크기 (= PHYSTOP >> 12)
+
+// 프레임별 유저 매핑 수 (PTE 개수). vm.c가 PTE를 만들고 지울 때 원자적으로 올리고 내린다.
+// 0이 되는 순간 그 프레임을 해제하면 된다. 공유 0 페이지는 세지 않는다.
+static uint *pf_mapcnt;
+
+// 세대: 새 pfquery 스캔이 시작될 때마다 1씩 오른다. 갱신 경로는 읽기만 하므로
+// 카운터 캐시 라인을 CPU끼리 주고받지 않는다.
+static uint pf_epoch = 1;
 
 static inline uint pa_to_pfn(uint pa){ return pa >> 12; }
 
+// 소유자 필드 ↔ pid. 넘친 pid는 잘라 남의 pid로 보이게 하지 않고 PF_OWNER_OVF로 묶는다.
+// pid -2는 이미 넘친 소유자(pgdir_owner가 pf_owner로 되읽은 값)라 그대로 유지한다.
+static inline uint pf_owner_enc(int pid){
+  if(pid < 0) return pid == -2 ? PF_OWNER_OVF : 0;
+  return pid < PF_OWNER_OVF - 1 ? pid + 1 : PF_OWNER_OVF;
+}
+
+static inline int pf_owner_dec(uint info){
+  uint o = info >> 16;
+  return o == PF_OWNER_OVF ? -2 : (int)o - 1;
+}
+
+static inline void pf_store(uint pfn, uint info, uint tick){
+  __atomic_store_n(&pftab[pfn].tick, tick, __ATOMIC_RELAXED);
+  __atomic_store_n(&pftab[pfn].gen, pf_epoch, __ATOMIC_RELAXED);
+  __atomic_store_n(&pftab[pfn].info, info, __ATOMIC_RELEASE);
+}
+
 static inline void pf_reset(uint pfn){
-  if(pfn >= PFNNUM) return;
-  pf_info[pfn].frame_index = pfn;
-  pf_info[pfn].allocated = 0;
-  pf_info[pfn].pid = -1;
-  pf_info[pfn].start_tick = 0;
+  if(pfn >= pf_nframes) return;
+  pf_store(pfn, 0, 0);
+}
+
+// 부팅 시 vstart부터 프레임 테이블과 버디 order 표를 잘라 내고, 남은 영역의 시작을 돌려준다.
+// entry.S의 초기 매핑(vend, 4MB)을 넘으면 그 뒤를 덮어쓰게 되므로 멈춘다.
+static uchar *buddy_order;
+static char*
+pftab_carve(char *vstart, char *vend)
+{
+  char *p = (char*)PGROUNDUP((uint)vstart);
+  pf_nframes = PHYSTOP >> 12;
+  pftab = (struct pframe*)p;
+  p += pf_nframes * sizeof(struct pframe);
+  pf_mapcnt = (uint*)p;
+  p += pf_nframes * sizeof(uint);
+  buddy_order = (uchar*)p;
+  p += pf_nframes;
+  p = (char*)PGROUNDUP((uint)p);
+  if(p > vend)
+    panic("pftab_carve: frame table exceeds early mapping");
+  memset(pftab, 0, p - (char*)pftab);
+  return p;
+}
+
+uint
+pf_mapget(uint pfn)
+{
+  if(pfn >= pf_nframes) return 0;
+  return __atomic_load_n(&pf_mapcnt[pfn], __ATOMIC_RELAXED);
+}
+
+void
+pf_mapinc(uint pfn)
+{
+  if(pfn >= pf_nframes) return;
+  __atomic_add_fetch(&pf_mapcnt[pfn], 1, __ATOMIC_RELAXED);
+}
+
+// 매핑 하나를 뺀 뒤 남은 수. 0이면 호출한 쪽이 프레임을 해제한다.
+uint
+pf_mapdec(uint pfn)
+{
+  uint n;
+
+  if(pfn >= pf_nframes) return 0;
+  n = __atomic_sub_fetch(&pf_mapcnt[pfn], 1, __ATOMIC_ACQ_REL);
+  if((int)n < 0)
+    panic("pf_mapdec");
+  return n;
+}
+
+// 프레임 [start, start+n) 을 physframe_info 형식으로 풀어 out에 채운다.
+int
+pf_export(struct physframe_info *out, uint start, int n)
+{
+  int i;
+
+  if(start >= pf_nframes) return 0;
+  if(n > pf_nframes - start) n = pf_nframes - start;
+  for(i = 0; i < n; i++){
+    uint info = __atomic_load_n(&pftab[start+i].info, __ATOMIC_ACQUIRE);
+    out[i].frame_index = start + i;
+    out[i].allocated   = (info & PF_ALLOC) != 0;
+    out[i].pid         = pf_owner_dec(info);
+    out[i].start_tick  = __atomic_load_n(&pftab[start+i].tick, __ATOMIC_RELAXED);
+    out[i].type        = (info >> 8) & 0xFF;
+  }
+  return n;
 }
 
-// 초기화 루틴(한 번만 호출)
-static void pfinfo_init_once(void){
-  for(int i=0;i<PFNNUM;i++){
-    pf_info[i].frame_index = i;
-    pf_info[i].allocated = 0;
-    pf_info[i].pid = -1;
-    pf_info[i].start_tick = 0;
+// 프레임 소유자 pid (-1: 없음, -2: 16비트를 넘친 pid). 페이지 테이블을 그 pgdir 주인에게 달 때 쓴다.
+int
+pf_owner(uint pfn)
+{
+  if(pfn >= pf_nframes) return -1;
+  return pf_owner_dec(__atomic_load_n(&pftab[pfn].info, __ATOMIC_RELAXED));
+}
+
+// pid 소유 프레임을 용도별로 센다 (테이블 스캔, 통계용)
+void
+pf_usage(int pid, uint *pages)
+{
+  uint pfn, info;
+
+  memset(pages, 0, sizeof(uint) * PF_T_NTYPES);
+  for(pfn = 0; pfn < pf_nframes; pfn++){
+    info = __atomic_load_n(&pftab[pfn].info, __ATOMIC_RELAXED);
+    if((info & PF_ALLOC) && pf_owner_dec(info) == pid && ((info >> 8) & 0xFF) < PF_T_NTYPES)
+      pages[(info >> 8) & 0xFF]++;
+  }
+}
+
+// q->start부터 조건에 맞는 프레임을 최대 max개 out에 채우고, q->start를 이어 볼 위치로 옮긴다.
+// q->start == 0 이면 새 스캔: 현재 세대를 q->gen으로 돌려주고 세대를 올린다.
+int
+pf_query(struct pfquery *q, struct physframe_info *out, int max)
+{
+  uint pfn;
+  int n = 0;
+
+  if(q->start == 0)
+    q->gen = __atomic_fetch_add(&pf_epoch, 1, __ATOMIC_RELAXED);
+  for(pfn = q->start; pfn < pf_nframes && n < max; pfn++){
+    struct pframe *f = &pftab[pfn];
+    uint info = __atomic_load_n(&f->info, __ATOMIC_ACQUIRE);
+    uint tick = __atomic_load_n(&f->tick, __ATOMIC_RELAXED);
+    int alloc = (info & PF_ALLOC) != 0;
+    int pid   = pf_owner_dec(info);
+
+    if(q->alloc >= 0 && alloc != q->alloc) continue;
+    if(q->pid != -1 && pid != q->pid) continue;
+    if(tick < q->tick_lo || (q->tick_hi && tick > q->tick_hi)) continue;
+    if(q->since_gen && __atomic_load_n(&f->gen, __ATOMIC_RELAXED) <= q->since_gen) continue;
+
+    out[n].frame_index = pfn;
+    out[n].allocated   = alloc;
+    out[n].pid         = pid;
+    out[n].start_tick  = tick;
+    out[n].type        = (info >> 8) & 0xFF;
+    n++;
   }
+  q->start = pfn;
+  return n;
 }
 
 void freerange(void *vstart, void *vend);
@@ -44,14 +199,119 @@ extern char end[]; // first address after kernel loaded from ELF file
 
 struct run {
   struct run *next;
+  struct run *prev;   // 버디 free 리스트에서 O(1) 제거용
 };
 
+// ---- 버디 할당기 ----
+// area[k]: 2^k 페이지짜리 free 블록 리스트 (블록 시작 PFN은 2^k 정렬).
+// buddy_order[pfn]: pfn이 free 블록의 머리면 order+1, 아니면 0. (pftab_carve가 배치)
 struct {
   struct spinlock lock;
   int use_lock;
-  struct run *freelist;
+  struct run *area[MAXORDER+1];
+  uint nfree[MAXORDER+1];   // order별 free 블록 수
+  uint npages;              // 버디에 있는 free 페이지 총합
 } kmem;
 
+static inline struct run* pfn_to_run(uint pfn){ return (struct run*)P2V(pfn << 12); }
+
+static void
+area_push(uint pfn, int order)
+{
+  struct run *r = pfn_to_run(pfn);
+  r->prev = 0;
+  r->next = kmem.area[order];
+  if(r->next)
+    r->next->prev = r;
+  kmem.area[order] = r;
+  kmem.nfree[order]++;
+  kmem.npages += 1 << order;
+  buddy_order[pfn] = order + 1;
+}
+
+static void
+area_remove(uint pfn, int order)
+{
+  struct run *r = pfn_to_run(pfn);
+  if(r->prev)
+    r->prev->next = r->next;
+  else
+    kmem.area[order] = r->next;
+  if(r->next)
+    r->next->prev = r->prev;
+  kmem.nfree[order]--;
+  kmem.npages -= 1 << order;
+  buddy_order[pfn] = 0;
+}
+
+// 2^order 페이지 블록 할당. 가장 작은 충분한 블록을 반으로 쪼개 내려간다.
+// kmem.lock(사용 시) 보유 상태에서 호출. 실패 시 -1.
+static int
+buddy_alloc(int order)
+{
+  int k;
+  uint pfn;
+
+  for(k = order; k <= MAXORDER && kmem.area[k] == 0; k++)
+    ;
+  if(k > MAXORDER)
+    return -1;
+  pfn = V2P(kmem.area[k]) >> 12;
+  area_remove(pfn, k);
+  while(k > order){
+    k--;
+    area_push(pfn + (1 << k), k);   // 위쪽 절반은 다시 free
+  }
+  return pfn;
+}
+
+// 2^order 페이지 블록 반납. 짝(buddy)이 같은 order로 free면 계속 합친다.
+// kmem.lock(사용 시) 보유 상태에서 호출.
+static void
+buddy_free(uint pfn, int order)
+{
+  uint b;
+
+  while(order < MAXORDER){
+    b = pfn ^ (1 << order);
+    if(b >= pf_nframes || buddy_order[b] != order + 1)
+      break;
+    area_remove(b, order);
+    if(b < pfn)
+      pfn = b;
+    order++;
+  }
+  area_push(pfn, order);
+}
+
+// ---- 미리 0으로 채운 페이지 풀 ----
+// CPU가 놀 때(scheduler 유휴 루프) kzero_refill()이 페이지를 0으로 채워 두고,
+// 유저 메모리/페이지 테이블처럼 0 페이지가 필요한 곳은 kzalloc()으로 바로 가져간다.
+#define ZPOOL_MAX    256   // 풀 최대 크기 (1MB)
+#define ZPOOL_BATCH  8     // 유휴 루프 1회당 채우는 페이지 수
+
+static struct {
+  struct spinlock lock;
+  struct run *list;
+  int n;
+} zpool;
+
+static struct run*
+zpool_pop(void)
+{
+  struct run *r;
+
+  acquire(&zpool.lock);
+  if((r = zpool.list)){
+    zpool.list = r->next;
+    zpool.n--;
+  }
+  release(&zpool.lock);
+  if(r)
+    r->next = 0;   // 링크로 쓰던 첫 워드도 다시 0으로
+  return r;
+}
+
 // Initialization happens in two phases.
 // 1. main() calls kinit1() while still using entrypgdir to place just
 // the pages mapped by entrypgdir on free list.
@@ -61,8 +321,9 @@ void
 kinit1(void *vstart, void *vend)
 {
   initlock(&kmem.lock, "kmem");
+  initlock(&zpool.lock, "zpool");
   kmem.use_lock = 0;
-  pfinfo_init_once();              // pf_info[] 전체 초기화는 여기서 한 번만
+  vstart = pftab_carve(vstart, vend);    // 프레임 테이블은 부팅 시 한 번만 배치
   freerange(vstart, vend);
 }
 
@@ -73,15 +334,112 @@ kinit2(void *vstart, void *vend)
   kmem.use_lock = 1;
 }
 
+// [vstart, vend)를 정렬이 허용하는 가장 큰 블록 단위로 버디에 넣는다.
 void
 freerange(void *vstart, void *vend)
 {
   char *p;
+  int order;
+
   p = (char*)PGROUNDUP((uint)vstart);
-  for(; p + PGSIZE <= (char*)vend; p += PGSIZE)
-    kfree(p);
+  while(p + PGSIZE <= (char*)vend){
+    uint pfn = pa_to_pfn(V2P(p));
+    for(order = MAXORDER; order > 0; order--)
+      if((pfn & ((1 << order) - 1)) == 0 && p + (PGSIZE << order) <= (char*)vend)
+        break;
+    kfree_order(p, order);
+    p += PGSIZE << order;
+  }
 }
 //PAGEBREAK: 21
+// ---- CPU별 페이지 매거진 ----
+// 정상 운행(use_lock) 이후 kalloc/kfree는 자기 CPU의 매거진에서 먼저 처리하고,
+// 비었거나 넘칠 때만 kmem.lock을 잡아 버디와 PCP_BATCH장씩 주고받는다.
+// 매거진은 그 CPU만 만지므로 pushcli 구간에서 락 없이 다룬다.
+#define PCP_MAX    64   // CPU당 최대 보유 페이지
+#define PCP_BATCH  32   // 버디와 한 번에 주고받는 페이지 수
+
+static struct pcp {
+  struct run *list;
+  int n;
+  int typecnt[PF_T_NTYPES];   // 이 CPU에서 할당(+)/해제(-)한 용도별 페이지 수
+} __attribute__((aligned(64))) pcp[NCPU];   // CPU끼리 캐시 라인 공유 방지
+
+static int boot_typecnt[PF_T_NTYPES];       // use_lock 이전 (단일 CPU)
+
+// 용도별 카운터: CPU별로 따로 세고 읽을 때 합친다 (공유 카운터 캐시 라인 경합 없음)
+static void
+pf_count(uint type, int delta)
+{
+  if(type >= PF_T_NTYPES)
+    return;
+  if(!kmem.use_lock){
+    boot_typecnt[type] += delta;
+    return;
+  }
+  pushcli();
+  pcp[cpuid()].typecnt[type] += delta;
+  popcli();
+}
+
+// 해제되는 프레임: 용도 카운터를 되돌리고 추적 정보를 지운다.
+static void
+pf_release(uint pfn)
+{
+  if(pfn >= pf_nframes) return;
+  uint info = __atomic_load_n(&pftab[pfn].info, __ATOMIC_RELAXED);
+  if(info & PF_ALLOC)
+    pf_count((info >> 8) & 0xFF, -1);
+  pf_reset(pfn);
+}
+
+// 용도별 사용 중 페이지 수 (시스템 전체)
+void
+kmem_typeinfo(uint *pages)
+{
+  int t, i, sum;
+
+  for(t = 0; t < PF_T_NTYPES; t++){
+    sum = boot_typecnt[t];
+    for(i = 0; i < ncpu; i++)
+      sum += pcp[i].typecnt[t];
+    pages[t] = sum < 0 ? 0 : sum;
+  }
+}
+
+// 버디에서 order-0 페이지를 최대 PCP_BATCH장 가져온다 (락 1회).
+static void
+pcp_refill(struct pcp *c)
+{
+  struct run *r;
+  int i, pfn;
+
+  acquire(&kmem.lock);
+  for(i = 0; i < PCP_BATCH && (pfn = buddy_alloc(0)) >= 0; i++){
+    r = pfn_to_run(pfn);
+    r->next = c->list;
+    c->list = r;
+    c->n++;
+  }
+  release(&kmem.lock);
+}
+
+// 매거진에서 PCP_BATCH장을 떼어 버디에 한 번에 반납한다 (락 1회).
+static void
+pcp_drain(struct pcp *c)
+{
+  struct run *r;
+  int i;
+
+  acquire(&kmem.lock);
+  for(i = 0; i < PCP_BATCH && (r = c->list); i++){
+    c->list = r->next;
+    c->n--;
+    buddy_free(pa_to_pfn(V2P(r)), 0);
+  }
+  release(&kmem.lock);
+}
+
 // Free the page of physical memory pointed at by v,
 // which normally should have been returned by a
 // call to kalloc().  (The exception is when
@@ -94,56 +452,202 @@ kfree(char *v)
   if((uint)v % PGSIZE || v < end || V2P(v) >= PHYSTOP)
     panic("kfree");
 
-  // poison & freelist 삽입
+  // 프레임 추적 정보 초기화 (프레임 단위 소유라 락 불필요)
+#ifdef KALLOC_POISON
+  // 디버그 빌드(make POISON=1): dangling 참조를 잡기 위해 쓰레기 값으로 채움
   memset(v, 1, PGSIZE);
+#endif
+  pf_release(pa_to_pfn(V2P(v)));
   r = (struct run*)v;
 
-  if(kmem.use_lock) acquire(&kmem.lock);
-  r->next = kmem.freelist;
-  kmem.freelist = r;
-  if(kmem.use_lock) release(&kmem.lock);
+  if(!kmem.use_lock){
+    // 부팅 초기: 단일 CPU, mycpu() 사용 불가 → 버디에 직접
+    buddy_free(pa_to_pfn(V2P(v)), 0);
+    return;
+  }
+
+  pushcli();
+  struct pcp *c = &pcp[cpuid()];
+  r->next = c->list;
+  c->list = r;
+  if(++c->n > PCP_MAX)
+    pcp_drain(c);
+  popcli();
+}
+extern uint ticks;
+
+// 할당된 프레임의 추적 정보 기록: 용도와 소유자는 호출자가 밝힌다
+// (지금 돌고 있는 myproc()이 주인이라는 보장이 없으므로).
+// 이 프레임은 지금 이 CPU만 소유하므로 kmem.lock/tickslock 없이 기록한다.
+// (ticks는 워드 하나라 락 없이 읽어도 찢어지지 않는다)
+static void
+pf_mark_alloc(uint pfn, int type, int pid)
+{
+  if(pfn >= pf_nframes) return;
+  pf_store(pfn, (pf_owner_enc(pid) << 16) | ((type & 0xFF) << 8) | PF_ALLOC,
+           kmem.use_lock ? ticks : 0);   // 부팅 초기엔 틱 미초기화
+  pf_count(type, 1);
+}
+
+// 매거진(없으면 버디, 그래도 없으면 0 페이지 풀)에서 한 장. 추적 정보는 기록하지 않는다.
+// 모두 바닥나면 슬랩 캐시의 빈 페이지를 거둬들이고(kmem_cache_reap) 한 번 더 시도한다.
+static struct run*
+kalloc_page(void)
+{
+  struct run *r;
+  int reaped = 0;
+
+  if(!kmem.use_lock){
+    int pfn = buddy_alloc(0);
+    r = pfn >= 0 ? pfn_to_run(pfn) : 0;
+  } else {
+retry:
+    pushcli();
+    struct pcp *c = &pcp[cpuid()];
+    if(c->n == 0)
+      pcp_refill(c);
+    r = c->list;
+    if(r){
+      c->list = r->next;
+      c->n--;
+    }
+    popcli();
+    if(r == 0)
+      r = zpool_pop();   // 메모리 부족: 0 페이지 풀도 일반 페이지로 내준다
+    if(r == 0 && !reaped){
+      reaped = 1;
+      if(kmem_cache_reap() > 0)
+        goto retry;
+    }
+  }
+  return r;
 }
-// Allocate one 4096-byte page of physical memory.
+
+// Allocate one 4096-byte page of physical memory
+// for the given use (PF_T_*) on behalf of pid (-1: kernel).
 // Returns a pointer that the kernel can use.
 // Returns 0 if the memory cannot be allocated.
-extern uint ticks;
-extern struct spinlock tickslock;
+char*
+kalloc_type(int type, int pid)
+{
+  struct run *r = kalloc_page();
+
+  if(r)
+    pf_mark_alloc(pa_to_pfn(V2P((char*)r)), type, pid);
+  return (char*)r;
+}
 
+// 용도를 밝히지 않는 커널 할당 (소유자 없음)
 char*
 kalloc(void)
 {
-  struct run *r;
+  return kalloc_type(PF_T_OTHER, -1);
+}
+
+// 물리적으로 연속인 2^order 페이지 (2^order 페이지 정렬).
+// 매거진을 거치지 않고 버디에서 바로 가져오며, 구성 프레임마다 추적 정보를 기록한다.
+char*
+kalloc_order(int order, int type, int pid)
+{
+  int pfn, i;
+
+  if(order == 0)
+    return kalloc_type(type, pid);
+  if(order < 0 || order > MAXORDER)
+    return 0;
 
   if(kmem.use_lock) acquire(&kmem.lock);
-  r = kmem.freelist;
-  if(r) kmem.freelist = r->next;
+  pfn = buddy_alloc(order);
   if(kmem.use_lock) release(&kmem.lock);
+  if(pfn < 0)
+    return 0;
 
-  if(r){
-    uint pa  = V2P((char*)r);
-    uint pfn = pa_to_pfn(pa);
-
-    if(!kmem.use_lock){
-      // ----- 부팅 초기: CPU/틱 미초기화, 안전하게 최소 기록만 -----
-      pf_info[pfn].allocated  = 1;
-      pf_info[pfn].pid        = -1;   // 아직 소유 프로세스 개념 없음
-      pf_info[pfn].start_tick = 0;
-      pf_info[pfn].frame_index= pfn;
-    } else {
-      // ----- 정상 운행 이후 -----
-      acquire(&kmem.lock);
-      pf_info[pfn].allocated = 1;
-      struct proc *p = myproc();          // 이제 안전
-      pf_info[pfn].pid = p ? p->pid : -1;
-
-      acquire(&tickslock);
-      pf_info[pfn].start_tick = ticks;
-      release(&tickslock);
-
-      pf_info[pfn].frame_index = pfn;
-      release(&kmem.lock);
-    }
+  for(i = 0; i < (1 << order); i++)
+    pf_mark_alloc(pfn + i, type, pid);
+  return (char*)pfn_to_run(pfn);
+}
+
+// kalloc_order()로 받은 블록 반납.
+void
+kfree_order(char *v, int order)
+{
+  uint pfn, i;
+
+  if(order == 0){
+    kfree(v);
+    return;
+  }
+  if(order < 0 || order > MAXORDER || (uint)v % (PGSIZE << order) ||
+     v < end || V2P(v) + (PGSIZE << order) > PHYSTOP)
+    panic("kfree_order");
+
+  pfn = pa_to_pfn(V2P(v));
+  for(i = 0; i < (1 << order); i++){
+#ifdef KALLOC_POISON
+    memset(v + i*PGSIZE, 1, PGSIZE);
+#endif
+    pf_release(pfn + i);
+  }
+
+  if(kmem.use_lock) acquire(&kmem.lock);
+  buddy_free(pfn, order);
+  if(kmem.use_lock) release(&kmem.lock);
+}
+
+// 단편화 보고용 스냅샷 (order별 free 블록 수 + 캐시에 묶인 페이지)
+void
+kmem_buddyinfo(struct buddyinfo *bi)
+{
+  int i;
+
+  memset(bi, 0, sizeof(*bi));
+  acquire(&kmem.lock);
+  for(i = 0; i <= MAXORDER; i++)
+    bi->nfree[i] = kmem.nfree[i];
+  release(&kmem.lock);
+  for(i = 0; i < ncpu; i++)
+    bi->pcp_pages += pcp[i].n;
+  bi->zpool_pages = zpool.n;
+}
+
+// 0으로 채워진 페이지 하나. 풀에 있으면 memset 없이 바로 반환.
+char*
+kzalloc_type(int type, int pid)
+{
+  struct run *r = 0;
+
+  if(kmem.use_lock && (r = zpool_pop()) != 0){
+    pf_mark_alloc(pa_to_pfn(V2P((char*)r)), type, pid);
+    return (char*)r;
   }
+  if((r = (struct run*)kalloc_type(type, pid)) != 0)
+    memset(r, 0, PGSIZE);
   return (char*)r;
 }
 
+char*
+kzalloc(void)
+{
+  return kzalloc_type(PF_T_OTHER, -1);
+}
+
+// scheduler 유휴 루프에서 호출: 풀이 ZPOOL_MAX보다 적으면 몇 장 0으로 채워 넣는다.
+// 버디가 바닥나면 마지막 남은 페이지를 풀에 묶어 두지 않도록 멈춘다.
+void
+kzero_refill(void)
+{
+  char *v;
+  int i;
+
+  for(i = 0; i < ZPOOL_BATCH && zpool.n < ZPOOL_MAX && kmem.npages; i++){
+    if((v = (char*)kalloc_page()) == 0)   // 추적 정보 없이: 풀 안의 페이지는 free로 보인다
+      return;
+    memset(v, 0, PGSIZE);
+
+    acquire(&zpool.lock);
+    ((struct run*)v)->next = zpool.list;
+    zpool.list = (struct run*)v;
+    zpool.n++;
+    release(&zpool.lock);
+  }
+}
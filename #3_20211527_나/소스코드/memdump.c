@@ -3,59 +3,141 @@
 #include "user.h"
 #include "fcntl.h"
 
-#define MAX_FRINFO 60000
+#define NCHUNK 512     // pfquery 한 번에 받을 최대 개수
+
+static char *tnames[PF_T_NTYPES] = {
+[PF_T_OTHER]  "other",
+[PF_T_USER]   "user",
+[PF_T_PGTBL]  "pgtbl",
+[PF_T_PGDIR]  "pgdir",
+[PF_T_KSTACK] "kstack",
+[PF_T_PIPE]   "pipe",
+[PF_T_IPT]    "ipt",
+};
+
+static char*
+tname(int t)
+{
+  return (t >= 0 && t < PF_T_NTYPES) ? tnames[t] : "?";
+}
+
+// -b: 용도별 페이지 수 (pid -1: 시스템 전체)
+static void
+type_report(int pid)
+{
+  struct memusage mu;
+  uint total = 0;
+
+  if (memusage(pid, &mu) < 0) {
+    printf(1, "memdump: memusage failed\n");
+    exit();
+  }
+  if (pid == -1) printf(1, "[memdump] usage by type (all)\n");
+  else           printf(1, "[memdump] usage by type (pid %d)\n", pid);
+  for (int t = 0; t < PF_T_NTYPES; t++)
+    total += mu.pages[t];
+  printf(1, "[type]\t[pages]\t[KB]\t[pct]\n");
+  for (int t = 0; t < PF_T_NTYPES; t++)
+    printf(1, "%s\t%d\t%d\t%d%%\n", tname(t), mu.pages[t], mu.pages[t] * 4,
+           total ? mu.pages[t] * 100 / total : 0);
+  printf(1, "total\t%d\t%d\n", total, total * 4);
+}
+
+// -f: 버디 order별 free 블록 수와 단편화 요약
+static void
+frag_report(void)
+{
+  struct buddyinfo bi;
+  uint total = 0, big = 0;
+
+  if (buddyinfo(&bi) < 0) {
+    printf(1, "memdump: buddyinfo failed\n");
+    exit();
+  }
+  printf(1, "[order]\t[pages]\t[free blocks]\t[free pages]\n");
+  for (int k = 0; k <= MAXORDER; k++) {
+    uint pages = bi.nfree[k] << k;
+    printf(1, "%d\t%d\t%d\t\t%d\n", k, 1 << k, bi.nfree[k], pages);
+    total += pages;
+    if (k == MAXORDER) big = pages;
+  }
+  printf(1, "buddy free %d pages, pcp %d, zpool %d\n",
+         total, bi.pcp_pages, bi.zpool_pages);
+  // 최대 order 블록에 들어 있지 않은 free 페이지 비율 (0: 단편화 없음)
+  if (total)
+    printf(1, "fragmentation %d%% (free pages outside order-%d blocks)\n",
+           (total - big) * 100 / total, MAXORDER);
+}
 
 static void
 usage(void)
 {
-  printf(1, "usage: memdump [-a] [-p PID]\n");
+  printf(1, "usage: memdump [-a] [-p PID] [-t LO HI] [-g GEN] | -f | -b [-p PID]\n");
   exit();
 }
 
 int
 main(int argc, char *argv[])
 {
-  int show_all = 0;      // -a가 있을 때만 free 프레임까지 표시
-  int filter_pid = -1;   // -p로 지정된 PID만 표시(기본: 필터 없음)
+  struct pfquery q;
+  static struct physframe_info buf[NCHUNK];
+  int breakdown = 0;
 
   if (argc == 1) usage();
 
+  // 필터는 커널이 적용한다 (기본: 할당된 프레임만)
+  memset(&q, 0, sizeof(q));
+  q.pid = -1;            // -p로 지정된 PID만 (기본: 필터 없음)
+  q.alloc = 1;           // -a가 있을 때만 free 프레임까지
+
   // 옵션 파싱
   for (int i = 1; i < argc; i++) {
     if (!strcmp(argv[i], "-a")) {
-      show_all = 1;
+      q.alloc = -1;
+    } else if (!strcmp(argv[i], "-b")) {
+      breakdown = 1;
+    } else if (!strcmp(argv[i], "-f")) {
+      frag_report();
+      exit();
     } else if (!strcmp(argv[i], "-p")) {
       if (i + 1 >= argc) usage();
-      filter_pid = atoi(argv[++i]);
+      q.pid = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-t")) {
+      if (i + 2 >= argc) usage();
+      q.tick_lo = atoi(argv[++i]);
+      q.tick_hi = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-g")) {
+      // 이전 출력의 gen 이후 바뀐 프레임만 (증분)
+      if (i + 1 >= argc) usage();
+      q.since_gen = atoi(argv[++i]);
     } else {
       usage();
     }
   }
 
-  static struct physframe_info buf[MAX_FRINFO];
-  int n = dump_physmem_info((void *)buf, MAX_FRINFO);
-  if (n < 0) {
-    printf(1, "memdump: dump_physmem_info failed\n");
+  if (breakdown) {
+    type_report(q.pid);
     exit();
   }
 
   printf(1, "[memdump] pid=%d\n", getpid());
-  printf(1, "[frame#]\t[alloc]\t[pid]\t[start_tick]\n");
+  printf(1, "[frame#]\t[alloc]\t[pid]\t[start_tick]\t[type]\n");
 
-  for (int i = 0; i < n; i++) {
-    int alloc = buf[i].allocated;
-    int pid   = buf[i].pid;
-
-    // 기본은 "할당된 것만" 출력, -a면 free까지 포함
-    if (!show_all && alloc == 0) continue;
-
-    // -p가 있으면 해당 PID만 출력(보통 alloc==1인 것만 의미 있음)
-    if (filter_pid != -1 && pid != filter_pid) continue;
-
-    printf(1, "%d\t\t%d\t%d\t%d\n",
-           buf[i].frame_index, alloc, pid, buf[i].start_tick);
-  }
+  int n, total = 0;
+  do {
+    n = pfquery(&q, buf, NCHUNK);
+    if (n < 0) {
+      printf(1, "memdump: pfquery failed\n");
+      exit();
+    }
+    for (int i = 0; i < n; i++)
+      printf(1, "%d\t\t%d\t%d\t%d\t\t%s\n",
+             buf[i].frame_index, buf[i].allocated, buf[i].pid, buf[i].start_tick,
+             buf[i].allocated ? tname(buf[i].type) : "-");
+    total += n;
+  } while (n == NCHUNK);
 
+  // 다음에 -g로 넘기면 그 뒤로 바뀐 프레임만 본다
+  printf(1, "[memdump] %d frames, gen %d\n", total, q.gen);
   exit();
 }
-
@@ -5,7 +5,7 @@
 
 static void
 usage(void) {
-  printf(1, "usage: memstress [-n pages] [-t ticks] [-w]\n");
+  printf(1, "usage: memstress [-n pages] [-t ticks] [-w] [-c nproc]\n");
   exit();
 }
 
@@ -15,6 +15,7 @@ main(int argc, char *argv[])
   int pages = 10;          // 기본: 10 페이지
   int hold_ticks = 200;    // 기본: 200 ticks 유지
   int do_write = 0;        // 기본: 쓰기 미수행
+  int nproc = 1;           // 기본: 단일 프로세스 (-c로 동시 실행 수 지정)
 
   // 옵션 파싱
   for (int i = 1; i < argc; i++) {
@@ -28,16 +29,29 @@ main(int argc, char *argv[])
       if (hold_ticks < 0) usage();
     } else if (!strcmp(argv[i], "-w")) {
       do_write = 1;
+    } else if (!strcmp(argv[i], "-c")) {
+      if (i + 1 >= argc) usage();
+      nproc = atoi(argv[++i]);
+      if (nproc <= 0) usage();
     } else {
       usage();
     }
   }
 
+  // -c: 같은 작업을 nproc개 프로세스가 동시에 수행 (CPU별 할당 확장성 측정)
+  for (int k = 1; k < nproc; k++) {
+    if (fork() == 0) {
+      nproc = 0;           // 자식 표시
+      break;
+    }
+  }
+
   int pid = getpid();
   printf(1, "[memstress] pid=%d pages=%d hold=%d ticks write=%d\n",
          pid, pages, hold_ticks, do_write);
 
   // 메모리 확보
+  int t0 = uptime();
   int inc = pages * 4096;
   char *base = sbrk(inc);
   if (base == (char*)-1) {
@@ -52,10 +66,15 @@ main(int argc, char *argv[])
     }
   }
 
+  printf(1, "[memstress] pid=%d alloc %d pages in %d ticks\n",
+         pid, pages, uptime() - t0);
+
   // 유지 시간
   sleep(hold_ticks);
 
   printf(1, "[memstress] pid=%d done\n", pid);
+  for (int k = 1; k < nproc; k++)   // 부모만 (자식은 nproc == 0)
+    wait();
   exit();
 }
 
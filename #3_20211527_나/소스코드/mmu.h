@@ -183,3 +183,7 @@ struct gatedesc {
 // OS-private bit for COW
 #define PTE_COW   0x200
 
+// 4MB 슈퍼페이지: PDE에 PTE_PS를 세우고 물리 연속 2^SPGORDER 페이지를 직접 매핑
+#define SPGSIZE   (PGSIZE*NPTENTRIES)
+#define SPGORDER  10
+
@@ -18,11 +18,47 @@ static uint parse_hex(const char *p){
 }
 
 static void usage(void){
-  printf(1, "usage: pfind <hex_pa_page>\n");
+  printf(1, "usage: pfind <hex_pa_page> | -a | -p PID\n");
   exit();
 }
 
+#define NBATCH 256
+
+// 메모리 전체 역매핑을 rmapscan 커서로 NBATCH개씩 받아 출력 (pid >= 0: 그 pid만)
+static void scan(int pid){
+  static struct rmapent buf[NBATCH];
+  struct rmapcur cur;
+  int n, total = 0, frames = 0;
+  uint last = (uint)-1;
+
+  memset(&cur, 0, sizeof(cur));
+  cur.pid = pid;
+  while((n = rmapscan(&cur, buf, NBATCH)) > 0){
+    for(int i=0;i<n;i++){
+      if(buf[i].pfn != last){
+        frames++;
+        last = buf[i].pfn;
+      }
+      printf(1, "PA_PAGE=0x%x  (pid=%d, va=0x%x, flags=0x%x)\n",
+             buf[i].pfn << 12, buf[i].pid, buf[i].va, buf[i].flags);
+    }
+    total += n;
+  }
+  if(n < 0){
+    printf(1, "pfind: rmapscan failed\n"); exit();
+  }
+  printf(1, "[pfind] %d refs over %d frames\n", total, frames);
+}
+
 int main(int argc, char **argv){
+  if(argc == 2 && !strcmp(argv[1], "-a")){
+    scan(-1);
+    exit();
+  }
+  if(argc == 3 && !strcmp(argv[1], "-p")){
+    scan(atoi(argv[2]));
+    exit();
+  }
   if(argc != 2) usage();
   uint pa_page = parse_hex(argv[1]) & ~0xFFF; // 페이지 정렬
 
@@ -92,7 +92,7 @@ found:
   release(&ptable.lock);
 
   // Allocate kernel stack.
-  if((p->kstack = kalloc()) == 0){
+  if((p->kstack = kalloc_type(PF_T_KSTACK, p->pid)) == 0){
     p->state = UNUSED;
     return 0;
   }
@@ -126,7 +126,7 @@ userinit(void)
   p = allocproc();
   
   initproc = p;
-  if((p->pgdir = setupkvm()) == 0)
+  if((p->pgdir = setupkvm_owner(p->pid)) == 0)
     panic("userinit: out of memory?");
   inituvm(p->pgdir, _binary_initcode_start, (int)_binary_initcode_size);
   p->sz = PGSIZE;
@@ -163,8 +163,10 @@ growproc(int n)
 
   sz = curproc->sz;
   if(n > 0){
-    if((sz = allocuvm(curproc->pgdir, sz, sz + n)) == 0)
+    // 지연 할당: sz만 늘리고, 프레임은 첫 접근 때 lazy_fault()가 붙인다 (읽기면 공유 0 페이지)
+    if(sz + n >= KERNBASE || sz + n < sz)
       return -1;
+    sz += n;
   } else if(n < 0){
     if((sz = deallocuvm(curproc->pgdir, sz, sz + n)) == 0)
       return -1;
@@ -343,6 +345,7 @@ scheduler(void)
 {
   struct proc *p;
   struct cpu *c = mycpu();
+  int ran;
   c->proc = 0;
   
   for(;;){
@@ -350,10 +353,12 @@ scheduler(void)
     sti();
 
     // Loop over process table looking for process to run.
+    ran = 0;
     acquire(&ptable.lock);
     for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
       if(p->state != RUNNABLE)
         continue;
+      ran = 1;
 
       // Switch to chosen process.  It is the process's job
       // to release ptable.lock and then reacquire it
@@ -371,6 +376,9 @@ scheduler(void)
     }
     release(&ptable.lock);
 
+    // 실행할 프로세스가 없었으면 이 CPU는 유휴: 0 페이지 풀을 채워 둔다.
+    if(!ran)
+      kzero_refill();
   }
 }
 
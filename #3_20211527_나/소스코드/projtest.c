@@ -37,8 +37,11 @@ main(void)
   char *base = sbrk(PGSIZE*2);
   base[0]=1; base[PGSIZE]=2;
 
-  uint pa=0, fl=0;
-  if(vtop(base,&pa,&fl)<0){ printf(1,"vtop syscall fail\n"); exit(); }
+  // 두 페이지를 vtop_range 한 번으로 (매핑된 것만)
+  struct vtopent ent[2];
+  if(vtop_range(base, 2, ent, VTR_PRESENT) != 2){ printf(1,"vtop_range: 2 pages expected\n"); exit(); }
+  printf(1,"[B] vtop_range: 0x%x->0x%x, 0x%x->0x%x\n", ent[0].va, ent[0].pa, ent[1].va, ent[1].pa);
+  uint pa=ent[0].pa, fl=ent[0].flags;
   char va_hex[16], pfn_hex[16];
   to_hex((uint)base, va_hex);
   to_hex(pa & ~(PGSIZE-1), pfn_hex);
@@ -0,0 +1,338 @@
+// Slab allocator for small kernel objects.
+//
+// 캐시(kmem_cache) 하나가 같은 크기의 객체를 관리한다.
+// 슬랩 = kalloc() 페이지 하나: 맨 앞에 struct slab 헤더, 뒤에 객체들.
+// 객체 주소를 PGROUNDDOWN 하면 헤더가 나오므로 kmem_cache_free()는 캐시를
+// 따로 받지 않아도 된다(슬랩 헤더로 검증만).
+//
+// CPU마다 객체 매거진(MAG_SIZE개)을 두어 보통은 pushcli 구간에서 락 없이
+// 주고받고, 비었거나 넘칠 때만 캐시 락을 잡아 MAG_BATCH개씩 슬랩과 교환한다.
+// mpinit() 전(lapic == 0)에는 mycpu()를 쓸 수 없으므로 매거진을 건너뛴다.
+//
+// 페이지는 쓰는 만큼만 붙고, 빈 슬랩은 캐시마다 하나만 남긴다. kalloc이 바닥나면
+// kmem_cache_reap()이 그 하나와 (이 CPU) 매거진에 묶인 객체까지 풀어 페이지를 돌려준다.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "memlayout.h"
+#include "mmu.h"
+#include "x86.h"
+#include "spinlock.h"
+#include "proc.h"
+
+#define NCACHE     16
+#define MAG_SIZE   16
+#define MAG_BATCH  8
+
+struct slab {
+  struct slab *next;
+  struct kmem_cache *cache;
+  void *freelist;          // 슬랩 안 free 객체 (첫 워드로 연결)
+  uint inuse;              // 나간 객체 수 (매거진에 있는 것 포함)
+};
+
+struct kmem_cache {
+  char name[16];
+  uint objsize;
+  uint perslab;            // 슬랩당 객체 수
+  int type;                // 슬랩 페이지의 프레임 용도 (PF_T_*)
+  struct spinlock lock;
+  struct slab *partial;    // free 객체가 남은 슬랩
+  struct slab *full;       // 꽉 찬 슬랩
+  struct slab *empty;      // 전부 돌아온 슬랩 (하나까지만 보관)
+  uint nslabs;
+  uint nalloc;             // 매거진 밖으로 나간(사용 중) 객체 수
+  uint hiwat;              // nalloc 최대치
+  uint nfail;              // 슬랩 페이지를 못 얻어 0을 돌려준 할당 수
+  uint reaped;             // reap으로 돌려준 페이지 수
+  struct mag {
+    void *obj[MAG_SIZE];
+    int n;
+  } __attribute__((aligned(64))) mag[NCPU];
+};
+
+static struct {
+  struct spinlock lock;
+  struct kmem_cache cache[NCACHE];
+  int n;
+} slabtab;
+
+static int slab_inited;
+
+extern volatile uint *lapic;   // lapic.c
+
+#define SLAB_HDR  ((sizeof(struct slab) + 7) & ~7)
+
+static inline struct slab* obj_slab(void *obj){
+  return (struct slab*)PGROUNDDOWN((uint)obj);
+}
+
+static void
+slab_unlink(struct slab **head, struct slab *s)
+{
+  for(; *head; head = &(*head)->next)
+    if(*head == s){
+      *head = s->next;
+      return;
+    }
+  panic("slab_unlink");
+}
+
+// 캐시 생성. 같은 이름이 이미 있으면 그것을 돌려준다.
+// type: 슬랩 페이지를 프레임 테이블에 어떤 용도로 기록할지 (PF_T_*)
+struct kmem_cache*
+kmem_cache_create(char *name, uint objsize, int type)
+{
+  struct kmem_cache *c;
+  int i;
+
+  if(!slab_inited){
+    initlock(&slabtab.lock, "slabtab");
+    slab_inited = 1;
+  }
+  if(objsize < sizeof(void*))
+    objsize = sizeof(void*);
+  objsize = (objsize + 7) & ~7;
+  if(objsize > PGSIZE - SLAB_HDR)
+    panic("kmem_cache_create: too big");
+
+  acquire(&slabtab.lock);
+  for(i = 0; i < slabtab.n; i++)
+    if(strncmp(slabtab.cache[i].name, name, sizeof(c->name)) == 0){
+      release(&slabtab.lock);
+      return &slabtab.cache[i];
+    }
+  if(slabtab.n == NCACHE)
+    panic("kmem_cache_create: no slot");
+  c = &slabtab.cache[slabtab.n++];
+  release(&slabtab.lock);
+
+  memset(c, 0, sizeof(*c));
+  safestrcpy(c->name, name, sizeof(c->name));
+  c->objsize = objsize;
+  c->perslab = (PGSIZE - SLAB_HDR) / objsize;
+  c->type = type;
+  initlock(&c->lock, "slab");
+  return c;
+}
+
+// 새 슬랩 페이지를 만들어 partial에 붙인다. c->lock 보유 상태에서 호출.
+// kalloc이 바닥나면 reap이 캐시 락들을 잡으므로 페이지를 받는 동안엔 락을 놓는다.
+static struct slab*
+slab_grow(struct kmem_cache *c)
+{
+  struct slab *s;
+  char *p;
+  uint i;
+
+  release(&c->lock);
+  s = (struct slab*)kalloc_type(c->type, -1);
+  acquire(&c->lock);
+  if(s == 0){
+    c->nfail++;
+    return 0;
+  }
+  s->cache = c;
+  s->inuse = 0;
+  s->freelist = 0;
+  p = (char*)s + SLAB_HDR;
+  for(i = 0; i < c->perslab; i++, p += c->objsize){
+    *(void**)p = s->freelist;
+    s->freelist = p;
+  }
+  s->next = c->partial;
+  c->partial = s;
+  c->nslabs++;
+  return s;
+}
+
+// 슬랩에서 객체 하나. c->lock 보유 상태에서 호출.
+static void*
+slab_get(struct kmem_cache *c)
+{
+  struct slab *s;
+  void *obj;
+
+  if((s = c->partial) == 0){
+    if((s = c->empty) != 0){
+      c->empty = 0;
+      s->next = c->partial;
+      c->partial = s;
+    } else if(slab_grow(c) == 0)
+      return 0;
+    else
+      s = c->partial;        // grow가 락을 놓은 사이 다른 슬랩이 머리에 왔을 수 있다
+  }
+  obj = s->freelist;
+  s->freelist = *(void**)obj;
+  s->inuse++;
+  if(s->freelist == 0){
+    c->partial = s->next;
+    s->next = c->full;
+    c->full = s;
+  }
+  return obj;
+}
+
+// 객체를 슬랩에 돌려준다. c->lock 보유 상태에서 호출.
+static void
+slab_put(struct kmem_cache *c, void *obj)
+{
+  struct slab *s = obj_slab(obj);
+
+  if(s->cache != c)
+    panic("kmem_cache_free: wrong cache");
+  if(s->freelist == 0){
+    slab_unlink(&c->full, s);
+    s->next = c->partial;
+    c->partial = s;
+  }
+  *(void**)obj = s->freelist;
+  s->freelist = obj;
+  if(--s->inuse == 0){
+    slab_unlink(&c->partial, s);
+    if(c->empty == 0){
+      c->empty = s;          // 하나는 남겨 두어 grow/free 왕복을 막는다
+      s->next = 0;
+    } else {
+      c->nslabs--;
+      kfree((char*)s);
+    }
+  }
+}
+
+static inline void
+slab_count(struct kmem_cache *c)
+{
+  uint n = __atomic_add_fetch(&c->nalloc, 1, __ATOMIC_RELAXED);
+  if(n > c->hiwat)
+    c->hiwat = n;          // 경합 시 조금 덜 잡혀도 통계라 무방
+}
+
+void*
+kmem_cache_alloc(struct kmem_cache *c)
+{
+  struct mag *m;
+  void *obj = 0;
+  int i;
+
+  if(lapic == 0){
+    acquire(&c->lock);
+    obj = slab_get(c);
+    release(&c->lock);
+    if(obj)
+      slab_count(c);
+    return obj;
+  }
+
+  pushcli();
+  m = &c->mag[cpuid()];
+  if(m->n == 0){
+    acquire(&c->lock);
+    for(i = 0; i < MAG_BATCH && (obj = slab_get(c)) != 0; i++)
+      m->obj[m->n++] = obj;
+    release(&c->lock);
+  }
+  obj = m->n > 0 ? m->obj[--m->n] : 0;
+  if(obj)
+    slab_count(c);
+  popcli();
+  return obj;
+}
+
+void
+kmem_cache_free(struct kmem_cache *c, void *obj)
+{
+  struct mag *m;
+  int i;
+
+  if(obj_slab(obj)->cache != c)
+    panic("kmem_cache_free");
+  __atomic_sub_fetch(&c->nalloc, 1, __ATOMIC_RELAXED);
+
+  if(lapic == 0){
+    acquire(&c->lock);
+    slab_put(c, obj);
+    release(&c->lock);
+    return;
+  }
+
+  pushcli();
+  m = &c->mag[cpuid()];
+  if(m->n == MAG_SIZE){
+    acquire(&c->lock);
+    for(i = 0; i < MAG_BATCH; i++)
+      slab_put(c, m->obj[--m->n]);
+    release(&c->lock);
+  }
+  m->obj[m->n++] = obj;
+  popcli();
+}
+
+// 메모리 부족 시 kalloc이 부른다: 이 CPU 매거진을 슬랩에 되돌리고 빈 슬랩을 해제.
+// 다른 CPU의 매거진은 그 CPU만 만지므로 건드리지 않는다.
+// 돌려준 페이지 수를 반환.
+int
+kmem_cache_reap(void)
+{
+  struct kmem_cache *c;
+  struct slab *s;
+  struct mag *m;
+  int i, n, freed = 0;
+
+  if(!slab_inited)
+    return 0;
+  n = slabtab.n;
+  for(i = 0; i < n; i++){
+    c = &slabtab.cache[i];
+    pushcli();
+    acquire(&c->lock);
+    if(lapic){
+      m = &c->mag[cpuid()];
+      while(m->n > 0)
+        slab_put(c, m->obj[--m->n]);
+    }
+    if((s = c->empty) != 0){
+      c->empty = 0;
+      c->nslabs--;
+      kfree((char*)s);
+      c->reaped++;
+      freed++;
+    }
+    release(&c->lock);
+    popcli();
+  }
+  return freed;
+}
+
+// 캐시별 사용량 스냅샷 (slabinfo)
+int
+kmem_cache_info(struct slabinfo *out, int max)
+{
+  struct kmem_cache *c;
+  int i, k, n;
+
+  if(!slab_inited)
+    return 0;
+  acquire(&slabtab.lock);
+  n = slabtab.n < max ? slabtab.n : max;
+  release(&slabtab.lock);
+  for(i = 0; i < n; i++){
+    c = &slabtab.cache[i];
+    memset(&out[i], 0, sizeof(out[i]));
+    safestrcpy(out[i].name, c->name, sizeof(out[i].name));
+    acquire(&c->lock);
+    out[i].objsize = c->objsize;
+    out[i].perslab = c->perslab;
+    out[i].nslabs  = c->nslabs;
+    out[i].inuse   = c->nalloc;
+    out[i].hiwat   = c->hiwat;
+    out[i].nfail   = c->nfail;
+    out[i].reaped  = c->reaped;
+    for(k = 0; k < ncpu; k++)
+      out[i].magobjs += c->mag[k].n;
+    release(&c->lock);
+  }
+  return n;
+}
@@ -0,0 +1,30 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+
+// slabinfo: 슬랩 캐시별 객체 크기/사용량/슬랩 페이지 수 출력
+
+#define MAXCACHE 16
+
+int
+main(int argc, char *argv[])
+{
+  static struct slabinfo si[MAXCACHE];
+
+  int n = slabinfo(si, MAXCACHE);
+  if (n < 0) {
+    printf(1, "slabinfo: syscall failed\n");
+    exit();
+  }
+
+  printf(1, "[name]\t\t[objsize]\t[inuse]\t[total]\t[slabs]\t[mag]\t[util%%]\t[peak]\t[fail]\t[reaped]\n");
+  for (int i = 0; i < n; i++) {
+    uint total = si[i].nslabs * si[i].perslab;   // 슬랩에 든 객체 칸 수
+    uint util  = total ? si[i].inuse * 100 / total : 0;
+    printf(1, "%s\t%s%d\t\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\n", si[i].name,
+           strlen(si[i].name) < 8 ? "\t" : "", si[i].objsize,
+           si[i].inuse, total, si[i].nslabs, si[i].magobjs, util,
+           si[i].hiwat, si[i].nfail, si[i].reaped);
+  }
+  exit();
+}
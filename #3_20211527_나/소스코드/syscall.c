@@ -107,6 +107,17 @@ extern int sys_dump_physmem_info(void);
 extern int sys_vtop(void);
 extern int sys_phys2virt(void);
 extern int sys_tlbstat(void);
+extern int sys_getscstat(void);
+extern int sys_resetscstat(void);
+extern int sys_buddyinfo(void);
+extern int sys_pfquery(void);
+extern int sys_slabinfo(void);
+extern int sys_memusage(void);
+extern int sys_stlbinfo(void);
+extern int sys_vtop_range(void);
+extern int sys_rmapscan(void);
+extern int sys_iptstat(void);
+extern int sys_stlbpid(void);
 
 static int (*syscalls[])(void) = {
 [SYS_fork]    sys_fork,
@@ -134,8 +145,72 @@ static int (*syscalls[])(void) = {
 [SYS_vtop]        sys_vtop,
 [SYS_phys2virt]   sys_phys2virt,
 [SYS_tlbstat]     sys_tlbstat,
+[SYS_getscstat]   sys_getscstat,
+[SYS_resetscstat] sys_resetscstat,
+[SYS_buddyinfo]   sys_buddyinfo,
+[SYS_pfquery]     sys_pfquery,
+[SYS_slabinfo]    sys_slabinfo,
+[SYS_memusage]    sys_memusage,
+[SYS_stlbinfo]    sys_stlbinfo,
+[SYS_vtop_range]  sys_vtop_range,
+[SYS_rmapscan]    sys_rmapscan,
+[SYS_iptstat]     sys_iptstat,
+[SYS_stlbpid]     sys_stlbpid,
 };
 
+// ---------- 시스템콜 번호별 호출/에러/사이클 통계 ----------
+// CPU별로 따로 누적해 디스패처에서 락을 잡지 않는다(갱신은 pushcli 구간).
+// scstat_pid >= 0 이면 해당 pid의 호출만 센다.
+#define NSYSCALL NELEM(syscalls)
+static struct syscallstat scstat[NCPU][NSYSCALL];
+static int scstat_pid = -1;
+
+static void
+scstat_account(int num, int ret, uint64 cyc)
+{
+  struct syscallstat *s;
+
+  pushcli();
+  s = &scstat[cpuid()][num];
+  s->calls++;
+  if(ret < 0)
+    s->errors++;
+  s->cycles += cyc;
+  if(cyc > s->maxcyc)
+    s->maxcyc = cyc;
+  popcli();
+}
+
+// CPU별 통계를 합쳐 out[0..max-1]에 채운다. 채운 개수(= 번호 범위)를 반환.
+int
+scstat_read(struct syscallstat *out, int max)
+{
+  int c, i;
+
+  if(max > NSYSCALL)
+    max = NSYSCALL;
+  memset(out, 0, sizeof(struct syscallstat) * max);
+  for(c = 0; c < ncpu; c++){
+    for(i = 0; i < max; i++){
+      struct syscallstat *s = &scstat[c][i];
+      out[i].calls  += s->calls;
+      out[i].errors += s->errors;
+      out[i].cycles += s->cycles;
+      if(s->maxcyc > out[i].maxcyc)
+        out[i].maxcyc = s->maxcyc;
+    }
+  }
+  return max;
+}
+
+// 통계를 0으로 되돌리고, 이후 pid만 집계한다(pid < 0: 전체).
+void
+scstat_reset(int pid)
+{
+  scstat_pid = pid < 0 ? -1 : pid;
+  memset(scstat, 0, sizeof(scstat));
+}
+
 void
 syscall(void)
 {
@@ -144,7 +219,11 @@ syscall(void)
 
   num = curproc->tf->eax;
   if(num > 0 && num < NELEM(syscalls) && syscalls[num]) {
-    curproc->tf->eax = syscalls[num]();
+    uint64 t0 = rdtsc();
+    int ret = syscalls[num]();
+    curproc->tf->eax = ret;
+    if(scstat_pid < 0 || scstat_pid == curproc->pid)
+      scstat_account(num, ret, rdtsc() - t0);
   } else {
     cprintf("%d %s: unknown sys call %d\n",
             curproc->pid, curproc->name, num);
@@ -24,4 +24,15 @@
 #define SYS_vtop        23
 #define SYS_phys2virt   24
 #define SYS_tlbstat     25
+#define SYS_getscstat   26
+#define SYS_resetscstat 27
+#define SYS_buddyinfo   28
+#define SYS_pfquery     29
+#define SYS_slabinfo    30
+#define SYS_memusage    31
+#define SYS_stlbinfo    32
+#define SYS_vtop_range  33
+#define SYS_rmapscan    34
+#define SYS_iptstat     35
+#define SYS_stlbpid     36
 
@@ -0,0 +1,132 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "syscall.h"
+
+// syscallstat: 시스템콜 번호별 호출/에러/사이클 통계를 정렬해 출력
+//   syscallstat [-s calls|total|max]   : 출력 (기본: total 사이클 내림차순)
+//   syscallstat -r [-p PID]            : 초기화 (+ 이후 PID만 집계, 기본 전체)
+
+#define MAXSC 64
+
+static char *names[] = {
+[SYS_fork]    "fork",
+[SYS_exit]    "exit",
+[SYS_wait]    "wait",
+[SYS_pipe]    "pipe",
+[SYS_read]    "read",
+[SYS_kill]    "kill",
+[SYS_exec]    "exec",
+[SYS_fstat]   "fstat",
+[SYS_chdir]   "chdir",
+[SYS_dup]     "dup",
+[SYS_getpid]  "getpid",
+[SYS_sbrk]    "sbrk",
+[SYS_sleep]   "sleep",
+[SYS_uptime]  "uptime",
+[SYS_open]    "open",
+[SYS_write]   "write",
+[SYS_mknod]   "mknod",
+[SYS_unlink]  "unlink",
+[SYS_link]    "link",
+[SYS_mkdir]   "mkdir",
+[SYS_close]   "close",
+[SYS_dump_physmem_info] "dump_physmem_info",
+[SYS_vtop]        "vtop",
+[SYS_phys2virt]   "phys2virt",
+[SYS_tlbstat]     "tlbstat",
+[SYS_getscstat]   "getscstat",
+[SYS_resetscstat] "resetscstat",
+[SYS_buddyinfo]   "buddyinfo",
+[SYS_pfquery]     "pfquery",
+[SYS_slabinfo]    "slabinfo",
+[SYS_memusage]    "memusage",
+[SYS_stlbinfo]    "stlbinfo",
+[SYS_vtop_range]  "vtop_range",
+[SYS_rmapscan]    "rmapscan",
+[SYS_iptstat]     "iptstat",
+[SYS_stlbpid]     "stlbpid",
+};
+
+static void
+usage(void)
+{
+  printf(1, "usage: syscallstat [-s calls|total|max] | -r [-p PID]\n");
+  exit();
+}
+
+int
+main(int argc, char *argv[])
+{
+  int reset = 0, pid = -1;
+  int key = 1;                 // 0: calls, 1: total, 2: max
+  static struct syscallstat st[MAXSC];
+  static int order[MAXSC];
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-r")) {
+      reset = 1;
+    } else if (!strcmp(argv[i], "-p")) {
+      if (i + 1 >= argc) usage();
+      pid = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-s")) {
+      if (i + 1 >= argc) usage();
+      i++;
+      if (!strcmp(argv[i], "calls")) key = 0;
+      else if (!strcmp(argv[i], "total")) key = 1;
+      else if (!strcmp(argv[i], "max")) key = 2;
+      else usage();
+    } else {
+      usage();
+    }
+  }
+
+  if (reset) {
+    if (resetscstat(pid) < 0) {
+      printf(1, "syscallstat: reset failed\n");
+      exit();
+    }
+    if (pid >= 0) printf(1, "[syscallstat] reset, counting pid %d only\n", pid);
+    else          printf(1, "[syscallstat] reset, counting all processes\n");
+    exit();
+  }
+
+  int n = getscstat(st, MAXSC);
+  if (n < 0) {
+    printf(1, "syscallstat: getscstat failed\n");
+    exit();
+  }
+
+  // 호출된 번호만 골라 key 기준 내림차순 삽입 정렬
+  int m = 0;
+  for (int i = 1; i < n; i++) {
+    if (st[i].calls == 0) continue;
+    int j = m++;
+    while (j > 0) {
+      struct syscallstat *a = &st[order[j-1]], *b = &st[i];
+      int less;
+      if (key == 0)      less = a->calls < b->calls;
+      else if (key == 1) less = a->cycles < b->cycles;
+      else               less = a->maxcyc < b->maxcyc;
+      if (!less) break;
+      order[j] = order[j-1];
+      j--;
+    }
+    order[j] = i;
+  }
+
+  printf(1, "num\tname\t\tcalls\terrors\ttotal_cyc\tavg_cyc\tmax_cyc\n");
+  for (int k = 0; k < m; k++) {
+    int i = order[k];
+    char *name = (i < sizeof(names)/sizeof(names[0]) && names[i]) ? names[i] : "?";
+    printf(1, "%d\t%s\t%s%d\t%d\t", i, name, strlen(name) < 8 ? "\t" : "",
+           st[i].calls, st[i].errors);
+    print_u64(1, st[i].cycles);
+    printf(1, "\t");
+    print_u64(1, udiv64(st[i].cycles, st[i].calls));
+    printf(1, "\t");
+    print_u64(1, st[i].maxcyc);
+    printf(1, "\n");
+  }
+  exit();
+}
@@ -8,12 +8,6 @@
 #include "proc.h"
 #include "spinlock.h"
 
-extern struct {
-  struct spinlock lock;
-  int use_lock;
-  struct run *freelist;
-} kmem;
-
 int sys_dump_physmem_info(void);
 
 int
@@ -99,8 +93,6 @@ sys_uptime(void)
   return xticks;
 }
 
-extern struct physframe_info pf_info[]; // 전역 테이블
-extern const int PFN_TABLE_SIZE;
 
 int
 sys_dump_physmem_info(void)
@@ -111,15 +103,24 @@ sys_dump_physmem_info(void)
   if(argint(1, &maxe) < 0) return -1;
 
   if(maxe <= 0) return 0;
-  if (maxe > PFN_TABLE_SIZE) maxe = PFN_TABLE_SIZE;
-  // 스냅샷 일관성 보장: kmem.lock으로 보호
-  acquire(&kmem.lock);
-  int n = maxe;
-  // 연속 복사
-  int ok = copyout(myproc()->pgdir, (uint)uaddr,
-                   (void*)pf_info, sizeof(struct physframe_info)*n);
-  release(&kmem.lock);
-  if(ok < 0) return -1;
+  if (maxe > pf_nframes) maxe = pf_nframes;
+  // 압축 테이블을 physframe_info로 풀어 조각 단위로 복사 (갱신이 락 없는 원자적 store라
+  // 할당기를 멈출 필요 없음). 커널 스택 대신 커널 페이지 하나를 버퍼로 쓴다.
+  struct physframe_info *kbuf;
+  int chunk = PGSIZE / sizeof(struct physframe_info);
+  if((kbuf = (struct physframe_info*)kalloc()) == 0) return -1;
+  int n = 0;
+  while(n < maxe){
+    int m = pf_export(kbuf, n, maxe - n < chunk ? maxe - n : chunk);
+    if(m <= 0) break;
+    if(copyout(myproc()->pgdir, (uint)uaddr + n*sizeof(struct physframe_info),
+               (void*)kbuf, sizeof(struct physframe_info)*m) < 0){
+      kfree((char*)kbuf);
+      return -1;
+    }
+    n += m;
+  }
+  kfree((char*)kbuf);
   return n;
 }
 
@@ -152,22 +153,89 @@ int sys_vtop(void){
   return 0;
 }
 
-// phys2virt: pfn 역질의
+// vtop_range: [va, va+npages 페이지) 를 한 번에 변환. opt & VTR_PRESENT면 매핑된 것만.
+// 커널 페이지 하나를 버퍼로 삼아 가득 찰 때마다 한 번씩 복사한다. 채운 개수 반환.
+int sys_vtop_range(void){
+  int va, npages, opt;
+  char *u_out;
+  struct vtopent *kbuf;
+  int max = PGSIZE / sizeof(struct vtopent);
+
+  if(argint(0, &va) < 0 || argint(1, &npages) < 0 || argint(3, &opt) < 0) return -1;
+  if(npages <= 0) return 0;
+  if((uint)va >= KERNBASE) return -1;
+  if(npages > (KERNBASE - PGROUNDDOWN((uint)va)) / PGSIZE)
+    npages = (KERNBASE - PGROUNDDOWN((uint)va)) / PGSIZE;
+  if(argptr(2, &u_out, sizeof(struct vtopent) * npages) < 0) return -1;
+  if((kbuf = (struct vtopent*)kalloc()) == 0) return -1;
+
+  pde_t *pgdir = myproc()->pgdir;
+  uint a = PGROUNDDOWN((uint)va), left = npages, done;
+  int n = 0;
+  while(left > 0){
+    int m = vtop_range(pgdir, a, left, kbuf, max, opt & VTR_PRESENT, &done);
+    if(m > 0 && copyout(pgdir, (uint)u_out + n*sizeof(struct vtopent),
+                        (char*)kbuf, sizeof(struct vtopent) * m) < 0){
+      kfree((char*)kbuf);
+      return -1;
+    }
+    n += m;
+    a += done * PGSIZE;
+    left -= done;
+  }
+  kfree((char*)kbuf);
+  return n;
+}
+
+// rmapscan: 커서(cur)부터 역매핑 튜플을 out에 max개까지. 커서는 갱신해 돌려준다.
+// 0이 돌아오면 끝. 커널 페이지 하나를 버퍼로 삼아 찰 때마다 복사한다.
+int sys_rmapscan(void){
+  char *u_cur, *u_out;
+  int max;
+  struct rmapcur c;
+  struct rmapent *kbuf;
+  int chunk = PGSIZE / sizeof(struct rmapent);
+
+  if(argptr(0, &u_cur, sizeof(c)) < 0) return -1;
+  if(argint(2, &max) < 0) return -1;
+  if(max <= 0) return 0;
+  // 크기 계산이 32비트에서 넘치지 않도록 주소공간에 들어갈 수 있는 개수로 먼저 거른다
+  if(max > myproc()->sz / sizeof(struct rmapent)) return -1;
+  if(argptr(1, &u_out, sizeof(struct rmapent) * max) < 0) return -1;
+  memmove(&c, u_cur, sizeof(c));
+  if((kbuf = (struct rmapent*)kalloc()) == 0) return -1;
+
+  int n = 0, m;
+  while(n < max && (m = ipt_rmap(&c, kbuf, max - n < chunk ? max - n : chunk)) > 0){
+    if(copyout(myproc()->pgdir, (uint)u_out + n*sizeof(struct rmapent),
+               (char*)kbuf, sizeof(struct rmapent) * m) < 0){
+      kfree((char*)kbuf);
+      return -1;
+    }
+    n += m;
+  }
+  kfree((char*)kbuf);
+  if(copyout(myproc()->pgdir, (uint)u_cur, (char*)&c, sizeof(c)) < 0) return -1;
+  return n;
+}
+
+// phys2virt: pfn 역질의. IPT에서 max개(페이지 하나 분량까지)만 읽고 그중 유저 매핑만
+// 돌려주므로, 매핑이 더 있으면 조용히 잘린다 → 전부 필요하면 rmapscan을 쓴다.
 int sys_phys2virt(void){
   int pa_page, max;
   char *u_out;
+  struct vref *kbuf;
 
   if(argint(0, &pa_page) < 0) return -1;
   if(argint(2, &max) < 0) return -1;     // ← 먼저 max를 읽는다
   if(max <= 0) return 0;
-  if(max > 64) max = 64;
+  if(max > PGSIZE / sizeof(struct vref)) max = PGSIZE / sizeof(struct vref);
 
   // 이제 max를 반영해 사용자 버퍼 검증
   if(argptr(1, &u_out, sizeof(struct vref) * max) < 0) return -1;
 
-  struct vref kbuf[64];
+  if((kbuf = (struct vref*)kalloc()) == 0) return -1;
   int n = ipt_query((uint)pa_page >> 12, kbuf, max);
-  if(n <= 0) return 0;
 
   // --- 유저 페이지(PTE_U)만 남기기: in-place compact ---
   int m = 0;
@@ -178,7 +246,11 @@ int sys_phys2virt(void){
 
   // m <= max 이므로 사용자 버퍼 검증은 기존 max 기준이면 충분
   int bytes = sizeof(struct vref) * m;
-  if(copyout(myproc()->pgdir, (uint)u_out, (char*)kbuf, bytes) < 0) return -1;
+  if(m > 0 && copyout(myproc()->pgdir, (uint)u_out, (char*)kbuf, bytes) < 0){
+    kfree((char*)kbuf);
+    return -1;
+  }
+  kfree((char*)kbuf);
   return m;                         // 필터링 후 개수 반환
 }
 
@@ -192,3 +264,143 @@ int sys_tlbstat(void){
   if(copyout(myproc()->pgdir, (uint)u_misses, (char*)&m, sizeof(m)) < 0) return -1;
   return 0;
 }
+
+// stlbinfo: CPU별 소프트 TLB 통계 — 채운 CPU 수 반환
+int sys_stlbinfo(void){
+  int max;
+  char *u_out;
+  if(argint(1, &max) < 0) return -1;
+  if(max <= 0) return 0;
+  if(max > NCPU) max = NCPU;
+  if(argptr(0, &u_out, sizeof(struct stlbstat) * max) < 0) return -1;
+
+  struct stlbstat kbuf[NCPU];
+  int n = stlb_cpustats(kbuf, max);
+  if(copyout(myproc()->pgdir, (uint)u_out, (char*)kbuf, sizeof(struct stlbstat) * n) < 0) return -1;
+  return n;
+}
+
+// stlbpid: pid 하나의 소프트 TLB 히트/미스/밀려남/conflict miss (기록 없으면 -1)
+int sys_stlbpid(void){
+  int pid;
+  char *u_out;
+  struct stlbstat st;
+  if(argint(0, &pid) < 0) return -1;
+  if(argptr(1, &u_out, sizeof(st)) < 0) return -1;
+  if(stlb_pidstats(pid, &st) < 0) return -1;
+  if(copyout(myproc()->pgdir, (uint)u_out, (char*)&st, sizeof(st)) < 0) return -1;
+  return 0;
+}
+
+// iptstat: IPT 버킷 점유/체인 길이 분포, 엔트리 최대치, 락 대기 시간
+int sys_iptstat(void){
+  char *u_out;
+  struct iptstat st;
+  if(argptr(0, &u_out, sizeof(st)) < 0) return -1;
+  ipt_stats(&st);
+  if(copyout(myproc()->pgdir, (uint)u_out, (char*)&st, sizeof(st)) < 0) return -1;
+  return 0;
+}
+
+// getscstat: 시스템콜 번호별 통계 (out[번호]) — 채운 개수 반환
+int sys_getscstat(void){
+  int max;
+  char *u_out;
+  if(argint(1, &max) < 0) return -1;
+  if(max <= 0) return 0;
+  if(max > 64) max = 64;
+  if(argptr(0, &u_out, sizeof(struct syscallstat) * max) < 0) return -1;
+
+  // 64개면 1.5KB라 커널 스택 대신 커널 페이지 하나를 버퍼로 쓴다
+  struct syscallstat *kbuf;
+  if((kbuf = (struct syscallstat*)kalloc()) == 0) return -1;
+  int n = scstat_read(kbuf, max);
+  if(copyout(myproc()->pgdir, (uint)u_out, (char*)kbuf, sizeof(struct syscallstat) * n) < 0){
+    kfree((char*)kbuf);
+    return -1;
+  }
+  kfree((char*)kbuf);
+  return n;
+}
+
+// resetscstat: 통계 초기화, pid >= 0이면 이후 그 pid만 집계
+int sys_resetscstat(void){
+  int pid;
+  if(argint(0, &pid) < 0) return -1;
+  scstat_reset(pid);
+  return 0;
+}
+
+// pfquery: 커널에서 pid/할당 여부/틱 범위/세대로 걸러 out에 채운다.
+// 커널 페이지 하나를 버퍼로 조각 단위로 모아 복사하고 락은 잡지 않는다. q->start로 이어 받기.
+int sys_pfquery(void){
+  char *u_q, *u_out;
+  int max;
+  struct pfquery q;
+  struct physframe_info *kbuf;
+  int chunk = PGSIZE / sizeof(struct physframe_info);
+
+  if(argptr(0, &u_q, sizeof(q)) < 0) return -1;
+  if(argint(2, &max) < 0) return -1;
+  if(max <= 0) return 0;
+  // 크기 계산이 32비트에서 넘치지 않도록 주소공간에 들어갈 수 있는 개수로 먼저 거른다
+  if(max > myproc()->sz / sizeof(struct physframe_info)) return -1;
+  if(argptr(1, &u_out, sizeof(struct physframe_info) * max) < 0) return -1;
+  memmove(&q, u_q, sizeof(q));
+  if((kbuf = (struct physframe_info*)kalloc()) == 0) return -1;
+
+  int n = 0;
+  while(n < max && q.start < pf_nframes){
+    int m = pf_query(&q, kbuf, max - n < chunk ? max - n : chunk);
+    if(m > 0 && copyout(myproc()->pgdir, (uint)u_out + n*sizeof(struct physframe_info),
+                        (void*)kbuf, sizeof(struct physframe_info)*m) < 0){
+      kfree((char*)kbuf);
+      return -1;
+    }
+    n += m;
+  }
+  kfree((char*)kbuf);
+  if(copyout(myproc()->pgdir, (uint)u_q, (char*)&q, sizeof(q)) < 0) return -1;
+  return n;
+}
+
+// slabinfo: 슬랩 캐시별 사용량 — 채운 개수 반환
+int sys_slabinfo(void){
+  int max;
+  char *u_out;
+  if(argint(1, &max) < 0) return -1;
+  if(max <= 0) return 0;
+  if(max > 16) max = 16;
+  if(argptr(0, &u_out, sizeof(struct slabinfo) * max) < 0) return -1;
+
+  struct slabinfo kbuf[16];
+  int n = kmem_cache_info(kbuf, max);
+  if(copyout(myproc()->pgdir, (uint)u_out, (char*)kbuf, sizeof(struct slabinfo) * n) < 0) return -1;
+  return n;
+}
+
+// memusage: 용도별 사용 중 페이지 수. pid -1이면 시스템 전체(CPU별 카운터 합),
+// 아니면 프레임 테이블에서 그 pid 소유 프레임을 센다.
+int sys_memusage(void){
+  int pid;
+  char *u_out;
+  struct memusage mu;
+  if(argint(0, &pid) < 0) return -1;
+  if(argptr(1, &u_out, sizeof(mu)) < 0) return -1;
+  if(pid == -1)
+    kmem_typeinfo(mu.pages);
+  else
+    pf_usage(pid, mu.pages);
+  if(copyout(myproc()->pgdir, (uint)u_out, (char*)&mu, sizeof(mu)) < 0) return -1;
+  return 0;
+}
+
+// buddyinfo: order별 free 블록 수 + 매거진/0 페이지 풀 보유량
+int sys_buddyinfo(void){
+  char *u_out;
+  struct buddyinfo bi;
+  if(argptr(0, &u_out, sizeof(bi)) < 0) return -1;
+  kmem_buddyinfo(&bi);
+  if(copyout(myproc()->pgdir, (uint)u_out, (char*)&bi, sizeof(bi)) < 0) return -1;
+  return 0;
+}
@@ -0,0 +1,81 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "param.h"
+
+// tlbstat: CPU별 소프트 TLB 히트/미스/충돌/무효화 통계
+//   ucopy_hit/ucopy_walk: copyout이 STLB로 페이지 워크를 건너뛴/걸은 페이지 수
+//   cmiss: 방금 밀려난 엔트리를 다시 찾다 난 미스 (세트 충돌로 인한 미스)
+//   tlbstat -p PID : 그 프로세스의 히트/미스/밀려남/cmiss
+
+static void
+usage(void)
+{
+  printf(1, "usage: tlbstat [-p PID]\n");
+  exit();
+}
+
+// 히트율 % : hits*100은 히트가 4천만을 넘으면 32비트를 넘치므로 total을 먼저 나눈다
+static uint
+hitpct(uint hits, uint total)
+{
+  uint p;
+
+  if (total == 0) return 0;
+  if (total < 100) return hits * 100 / total;
+  p = hits / (total / 100);
+  return p > 100 ? 100 : p;
+}
+
+static void
+pidstat(int pid)
+{
+  struct stlbstat s;
+
+  if (stlbpid(pid, &s) < 0) {
+    printf(1, "tlbstat: no STLB activity recorded for pid %d\n", pid);
+    exit();
+  }
+  uint total = s.hits + s.misses;
+  printf(1, "pid\thits\tmisses\thit%%\tevicted\tcmiss\n");
+  printf(1, "%d\t%d\t%d\t%d\t%d\t%d\n", pid, s.hits, s.misses,
+         hitpct(s.hits, total), s.conflicts, s.cmisses);
+}
+
+int
+main(int argc, char *argv[])
+{
+  static struct stlbstat st[NCPU];
+  struct stlbstat sum;
+
+  if (argc == 3 && !strcmp(argv[1], "-p")) {
+    pidstat(atoi(argv[2]));
+    exit();
+  }
+  if (argc != 1) usage();
+
+  int n = stlbinfo(st, NCPU);
+  if (n < 0) {
+    printf(1, "tlbstat: stlbinfo failed\n");
+    exit();
+  }
+
+  memset(&sum, 0, sizeof(sum));
+  printf(1, "CPU\thits\tmisses\thit%%\tconflict\tcmiss\tinval\tucopy_hit\tucopy_walk\n");
+  for (int c = 0; c <= n; c++) {
+    struct stlbstat *s = (c < n) ? &st[c] : &sum;
+    uint total = s->hits + s->misses;
+    if (c < n) printf(1, "cpu%d", c);
+    else       printf(1, "all");
+    printf(1, "\t%d\t%d\t%d\t%d\t\t%d\t%d\t%d\t\t%d\n", s->hits, s->misses,
+           hitpct(s->hits, total), s->conflicts, s->cmisses, s->invals,
+           s->uhits, s->uwalks);
+    if (c < n) {
+      sum.hits += s->hits;       sum.misses += s->misses;
+      sum.conflicts += s->conflicts; sum.invals += s->invals;
+      sum.uhits += s->uhits;     sum.uwalks += s->uwalks;
+      sum.cmisses += s->cmisses;
+    }
+  }
+  exit();
+}
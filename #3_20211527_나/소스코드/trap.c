@@ -82,6 +82,9 @@ trap(struct trapframe *tf)
     // fault가 난 가상주소 (CR2)
     uint va = rcr2();
 
+	// 지연 할당: sz 안쪽인데 아직 매핑 안 된 힙 페이지의 첫 접근 (not-present)
+	if (!(tf->err & 0x1) && myproc() && lazy_fault(myproc()->pgdir, va, myproc()->sz, tf->err & 0x2) == 0)
+  		return;
 	// 성공 경로: 조용히 처리하고 복귀
 	if ((tf->err & 0x2) && myproc() && cow_fault(myproc()->pgdir, va) == 0)
   		return;
@@ -2,12 +2,29 @@ typedef unsigned int   uint;
 typedef unsigned short ushort;
 typedef unsigned char  uchar;
 typedef uint pde_t;
+typedef unsigned long long uint64;
 
 struct physframe_info {
   uint  frame_index;   // PFN
   int   allocated;     // 1: in use, 0: free
   int   pid;           // owner pid, kernel/none: -1
   uint  start_tick;    // first-use tick
+  int   type;          // 용도 (PF_T_*)
+};
+
+// 프레임 용도 (kalloc_type / memusage)
+#define PF_T_OTHER   0   // 용도 미지정 커널 할당 (kalloc)
+#define PF_T_USER    1   // 유저 데이터 (text/data/heap/stack)
+#define PF_T_PGTBL   2   // 페이지 테이블
+#define PF_T_PGDIR   3   // 페이지 디렉터리
+#define PF_T_KSTACK  4   // 커널 스택
+#define PF_T_PIPE    5   // 파이프 (슬랩)
+#define PF_T_IPT     6   // IPT 메타데이터 (슬랩)
+#define PF_T_NTYPES  7
+
+// 용도별 사용 중 페이지 수 (memusage)
+struct memusage {
+  uint pages[PF_T_NTYPES];
 };
 
 struct vref {
@@ -15,3 +32,98 @@ struct vref {
   uint va;     // 페이지 단위 가상주소 (PGROUNDDOWN)
   uint flags;  // PTE 권한 스냅샷
 };
+
+// IPT 해시/풀/락 통계 (iptstat)
+// 체인 길이 분포 칸: 0, 1, 2, 3, 4-7, 8-15, 16-31, 32+
+#define IPT_HIST 8
+struct iptstat {
+  uint nbuckets;         // pfn 버킷 수
+  uint npidbuckets;      // pid 버킷 수
+  uint nent;             // 현재 엔트리 수
+  uint hiwat;            // 엔트리 수 최대치
+  uint drops;            // 엔트리를 못 얻어 빠진 삽입
+  uint used;             // 비어 있지 않은 pfn 버킷 수
+  uint maxchain;         // 가장 긴 pfn 체인
+  uint hist[IPT_HIST];   // pfn 버킷 체인 길이 분포
+  uint pidhist[IPT_HIST];// pid 버킷 체인 길이 분포
+  uint lkacq;            // IPT 락 획득 수
+  uint lkcont;           // 그중 이미 잡혀 있던 수
+  uint64 lkwait;         // 락 대기 사이클 합
+  uint64 lkmax;          // 락 대기 최대 사이클
+};
+
+// 구간 변환 결과 한 칸 (vtop_range)
+struct vtopent {
+  uint va;     // 페이지 VA
+  uint pa;     // 프레임 PA (없으면 0)
+  uint flags;  // PTE 플래그 (없으면 0)
+};
+#define VTR_PRESENT  1   // vtop_range: 매핑된 페이지만 돌려준다
+
+// 역매핑 순회 커서 (rmapscan / pfind -a, -p)
+struct rmapcur {
+  int  pid;     // 이 pid의 매핑만 (-1: 전체)
+  uint start;   // 입력: 시작 PFN (처음엔 0) / 출력: 다음 호출이 이어 볼 PFN
+  uint end;     // 끝 PFN, 미포함 (0: 메모리 끝까지)
+  uint skip;    // start 프레임에서 이미 돌려준 매핑 수 (처음엔 0)
+};
+
+struct rmapent {
+  uint pfn;
+  uint pid;
+  uint va;
+  uint flags;
+};
+
+// CPU별 소프트 TLB 통계 (stlbinfo / tlbstat)
+struct stlbstat {
+  uint hits;
+  uint misses;
+  uint conflicts;  // 유효 엔트리를 밀어낸 fill (세트 충돌)
+  uint invals;     // 무효화된 엔트리 수
+  uint uhits;      // copyout이 STLB로 페이지 워크를 건너뛴 페이지 수
+  uint uwalks;     // copyout이 페이지 테이블을 걸은 페이지 수
+  uint cmisses;    // 방금 밀려난 키를 다시 찾다 난 미스 (conflict miss)
+};
+
+// 슬랩 캐시별 사용량 (slabinfo)
+struct slabinfo {
+  char name[16];
+  uint objsize;    // 객체 크기 (8바이트 정렬)
+  uint perslab;    // 슬랩(페이지)당 객체 수
+  uint nslabs;     // 보유 슬랩 페이지 수
+  uint inuse;      // 사용 중 객체 수
+  uint magobjs;    // CPU별 매거진에 대기 중인 객체 수
+  uint hiwat;      // 사용 중 객체 수 최대치
+  uint nfail;      // 슬랩 페이지를 못 얻어 실패한 할당 수
+  uint reaped;     // 메모리 부족 시 돌려준 슬랩 페이지 수
+};
+
+// 커널 측 필터링 프레임 덤프 (pfquery / memdump)
+struct pfquery {
+  int  pid;        // 소유 pid만 (-1: 전체)
+  int  alloc;      // -1: 전체, 0: free만, 1: 할당된 것만
+  uint tick_lo;    // start_tick >= tick_lo
+  uint tick_hi;    // start_tick <= tick_hi (0: 상한 없음)
+  uint since_gen;  // 이 세대 이후 바뀐 프레임만 (0: 전체)
+  uint start;      // 입력: 검색 시작 PFN (처음엔 0) / 출력: 다음 호출이 이어 볼 PFN
+  uint gen;        // 출력: 이번 스캔의 세대 (다음 since_gen으로 넘기면 증분 덤프)
+};
+
+// 버디 할당기: 최대 블록 = 2^MAXORDER 페이지 (4MB)
+#define MAXORDER 10
+
+// 단편화 보고 (buddyinfo / memdump -f)
+struct buddyinfo {
+  uint nfree[MAXORDER+1];  // order별 free 블록 수
+  uint pcp_pages;          // CPU별 매거진에 묶인 페이지
+  uint zpool_pages;        // 0 페이지 풀에 묶인 페이지
+};
+
+// 시스템콜 번호별 통계 (getscstat / syscallstat)
+struct syscallstat {
+  uint   calls;    // 호출 횟수
+  uint   errors;   // 반환값 < 0 인 횟수
+  uint64 cycles;   // 총 소요 사이클 (rdtsc)
+  uint64 maxcyc;   // 1회 최대 소요 사이클
+};
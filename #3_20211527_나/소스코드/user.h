@@ -37,10 +37,23 @@ void* memset(void*, int, uint);
 void* malloc(uint);
 void free(void*);
 int atoi(const char*);
+uint64 udiv64(uint64, uint64);
+void print_u64(int, uint64);
 
 // syscall 프로토타입
 int dump_physmem_info(void *addr, int max_entries);
 
 int vtop(void *va, uint *pa_out, uint *flags_out);                 // sw_vtop을 현재 프로세스 문맥에서 호출
-int phys2virt(uint pa_page, struct vref *out, int max);            // IPT 역질의
+int phys2virt(uint pa_page, struct vref *out, int max);            // IPT 역질의 (max개까지만, 넘치면 잘림 → rmapscan)
 int tlbstat(uint *hits, uint *misses);                             // 소프트 TLB 통계
+int getscstat(struct syscallstat *out, int max);                   // 시스템콜 번호별 통계
+int resetscstat(int pid);                                          // 통계 초기화 (+ pid 필터, -1: 전체)
+int buddyinfo(struct buddyinfo *out);                              // 버디 order별 free 블록 수
+int pfquery(struct pfquery *q, struct physframe_info *out, int max); // 조건 필터/증분 프레임 덤프
+int slabinfo(struct slabinfo *out, int max);                       // 슬랩 캐시별 사용량
+int memusage(int pid, struct memusage *out);                       // 용도별 페이지 수 (pid -1: 전체)
+int stlbinfo(struct stlbstat *out, int max);                       // CPU별 소프트 TLB 통계
+int vtop_range(void *va, int npages, struct vtopent *out, int opt); // 구간 일괄 변환 (opt: VTR_PRESENT)
+int rmapscan(struct rmapcur *cur, struct rmapent *out, int max);   // 커서 기반 역매핑 순회
+int iptstat(struct iptstat *out);                                  // IPT 버킷/풀/락 통계
+int stlbpid(int pid, struct stlbstat *out);                        // pid별 소프트 TLB 통계
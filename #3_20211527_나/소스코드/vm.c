@@ -8,8 +8,6 @@
 #include "elf.h"
 #include "spinlock.h"
 
-__attribute__((weak)) void pf_reset(uint pfn) { /* no-op; 실제 구현 있으면 그것이 링크됨 */ }
-
 int pf_ready = 0;          // pf 서브시스템 준비 여부 플래그 (전역 정의)
 void pf_mark_ready(void) { // 부팅 시 1로 세팅
   pf_ready = 1;
@@ -31,6 +29,12 @@ sw_vtop(pde_t *pgdir, const void *va, uint *pa_out, uint *flags_out)
   uint a = (uint)va;
   pde_t pde = pgdir[PDX(a)];
   if(!(pde & PTE_P)) return -1;
+  if(pde & PTE_PS){
+    // 4MB 슈퍼페이지: PDE가 곧 매핑, 하위 22비트가 오프셋
+    if(pa_out)     *pa_out     = PTE_ADDR(pde) + (a & (SPGSIZE-1));
+    if(flags_out)  *flags_out  = PTE_FLAGS(pde);
+    return 0;
+  }
   pte_t *pgtab = (pte_t*)P2V(PTE_ADDR(pde));
   pte_t pte = pgtab[PTX(a)];
   if(!(pte & PTE_P)) return -1;
@@ -43,138 +47,490 @@ sw_vtop(pde_t *pgdir, const void *va, uint *pa_out, uint *flags_out)
   return 0;
 }
 
-// ---------- (B) Soft TLB (direct-mapped) ----------
-#define STLB_BITS   9
-#define STLB_SIZE   (1<<STLB_BITS)
-struct stlb_entry { uint pid, va_page, pa_page, flags; };
-static struct stlb_entry stlb[STLB_SIZE];
-static struct spinlock stlblk;
-static uint tlb_hits, tlb_misses;
+// [va, va + npages*PGSIZE) 를 PDE 하나(4MB)당 한 번씩 읽어 out에 (va, pa, flags)를 채운다.
+// present_only면 매핑된 페이지만 담고, 없는 PDE 구간은 통째로 건너뛴다.
+// max칸이 차면 멈추며 훑은 페이지 수를 *done에 돌려준다(이어 받기용). 채운 칸 수 반환.
+// 읽기만 하므로 슈퍼페이지를 쪼개지 않는다.
+int
+vtop_range(pde_t *pgdir, uint va, uint npages, struct vtopent *out, int max,
+           int present_only, uint *done)
+{
+  uint i = 0, k, left, a;
+  int n = 0;
+
+  va = PGROUNDDOWN(va);
+  while(i < npages && n < max){
+    a = va + i*PGSIZE;
+    pde_t pde = pgdir[PDX(a)];
+    left = NPTENTRIES - PTX(a);
+    if(left > npages - i)
+      left = npages - i;
+    if(!(pde & PTE_P) && present_only){
+      i += left;
+      continue;
+    }
+    pte_t *pgtab = (pde & (PTE_P|PTE_PS)) == PTE_P ? (pte_t*)P2V(PTE_ADDR(pde)) : 0;
+    for(k = 0; k < left && n < max; k++, a += PGSIZE){
+      uint pa = 0, fl = 0;
+      if((pde & (PTE_P|PTE_PS)) == (PTE_P|PTE_PS)){
+        pa = PTE_ADDR(pde) + (a & (SPGSIZE-1));
+        fl = PTE_FLAGS(pde);
+      } else if(pgtab && (pgtab[PTX(a)] & PTE_P)){
+        pa = PTE_ADDR(pgtab[PTX(a)]);
+        fl = PTE_FLAGS(pgtab[PTX(a)]);
+      }
+      if(fl == 0 && present_only)
+        continue;
+      out[n].va = a;
+      out[n].pa = pa;
+      out[n].flags = fl;
+      n++;
+    }
+    i += k;
+  }
+  *done = i;
+  return n;
+}
+
+// ---------- (B) Soft TLB (CPU별 4-way set-associative) ----------
+// CPU마다 STLB_SETS개 세트 × STLB_WAYS 엔트리. 세트는 (pid, va_page) 해시로 고르고
+// 세트 안에서는 트리 pseudo-LRU(3비트)로 희생 엔트리를 고른다.
+//
+// 조회는 락 없이: 세트마다 seqlock(seq)을 두고, 쓰는 쪽(자기 CPU의 fill, 다른 CPU의
+// 무효화)은 그 CPU의 lock을 잡은 채 seq를 홀수→짝수로 올린다. 읽는 쪽은 seq가
+// 짝수이고 읽기 전후 같을 때만 결과를 믿는다.
+// 페이지 단위 무효화는 모든 CPU의 해당 세트를 돈다 (다른 CPU가 가진 사본도 지워야 하므로).
+//
+// 주소공간 세대(ASID 비슷한 것): 엔트리는 채울 때의 asgen[pid 해시]를 같이 적고,
+// 조회는 세대가 지금과 같을 때만 히트로 본다. 프로세스 전체/구간 무효화는
+// 세대 하나 올리는 것으로 끝나고(O(1)), 옛 엔트리는 조회/채우기 때 빈 칸 취급된다.
+// 해시 충돌한 다른 pid도 같이 비워지지만 정확성에는 문제없다.
+// 한 pid의 조회/채우기는 그 프로세스 문맥에서만 일어나므로 세대 증가와 경합하지 않는다.
+#define STLB_SETS   128
+#define STLB_WAYS   4
+#define ASGEN_SIZE  1024
+struct stlb_entry { uint pid, va_page, pa_page, flags, gen; };
+struct stlb_set {
+  uint seq;                        // 홀수: 수정 중
+  uint plru;                       // 트리 PLRU 비트 (b0: 루트, b1: 0/1쪽, b2: 2/3쪽)
+  struct stlb_entry e[STLB_WAYS];
+  struct stlb_entry ghost;         // 마지막으로 밀려난 엔트리 키 (conflict miss 판정용)
+};
+static struct stlb_cpu {
+  struct spinlock lock;            // 이 CPU 테이블의 쓰기 직렬화 (조회는 안 잡음)
+  struct stlb_set set[STLB_SETS];
+  uint hits, misses;
+  uint conflicts;                  // 유효 엔트리를 밀어낸 fill (세트 충돌)
+  uint invals;                     // 무효화된 엔트리 수
+  uint uhits, uwalks;              // copyout: STLB 히트 / 페이지 워크
+  uint cmisses;                    // 방금 밀려난 키를 다시 찾다 난 미스 (conflict miss)
+} __attribute__((aligned(64))) stlbs[NCPU];
+
+static uint asgen[ASGEN_SIZE];
+
+// pid별 통계: asgen처럼 pid 해시 칸 하나씩. 다른 pid가 칸을 쓰기 시작하면 0부터 다시 센다.
+// hits/misses는 CPU별 hits/misses와 같은 조회(stlb_lookup)만 센다 (copyout은 uhits/uwalks).
+// 히트/미스는 그 프로세스 문맥에서만 오르고, 밀려남(evicts)은 다른 CPU의 fill이 올린다.
+static struct stlb_pidstat {
+  uint pid;
+  uint hits, misses, evicts, cmisses;
+} stlbpid[ASGEN_SIZE];
+
+static struct stlb_pidstat* stlb_pidslot(uint pid){
+  struct stlb_pidstat *p = &stlbpid[pid & (ASGEN_SIZE-1)];
+  if(p->pid != pid){
+    p->hits = p->misses = p->evicts = p->cmisses = 0;
+    p->pid = pid;
+  }
+  return p;
+}
+
+static inline uint asgen_of(uint pid){
+  return __atomic_load_n(&asgen[pid & (ASGEN_SIZE-1)], __ATOMIC_ACQUIRE);
+}
+
+// 유효(빈 칸 아님 + 현재 세대) 엔트리인지
+static inline int stlb_live(struct stlb_entry *e){
+  return e->flags && e->gen == asgen_of(e->pid);
+}
 
 static inline uint stlb_idx(uint pid, uint va_page){
-  return (pid*1315423911u ^ va_page) & (STLB_SIZE-1);
+  return ((pid*1315423911u) ^ (va_page >> 12)) & (STLB_SETS-1);
+}
+
+// way를 방금 썼다고 표시: 지나는 비트마다 "반대쪽이 희생 후보"가 되게 돌린다
+static inline void plru_touch(struct stlb_set *s, int way){
+  uint b = s->plru;
+  if(way < 2){
+    b |= 1;
+    b = (way == 0) ? (b | 2) : (b & ~2u);
+  } else {
+    b &= ~1u;
+    b = (way == 2) ? (b | 4) : (b & ~4u);
+  }
+  s->plru = b;
+}
+
+static inline int plru_victim(struct stlb_set *s){
+  uint b = s->plru;
+  if(b & 1) return (b & 4) ? 3 : 2;
+  return (b & 2) ? 1 : 0;
+}
+
+static inline void set_write_begin(struct stlb_set *s){
+  __atomic_store_n(&s->seq, s->seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+static inline void set_write_end(struct stlb_set *s){
+  __atomic_store_n(&s->seq, s->seq + 1, __ATOMIC_RELEASE);
 }
 
 void stlb_init(void){
-  initlock(&stlblk, "stlb");
-  memset(stlb, 0, sizeof(stlb));
-  tlb_hits = tlb_misses = 0;
+  memset(stlbs, 0, sizeof(stlbs));
+  for(int c=0;c<NCPU;c++)
+    initlock(&stlbs[c].lock, "stlb");
+}
+
+// count: hits/misses에 반영할지 (copyout은 자기 카운터 uhits/uwalks를 따로 센다)
+static int stlb_probe(int pid, uint va_page, uint *pa_page, uint *flags, int count){
+  struct stlb_cpu *c;
+  struct stlb_set *s;
+  struct stlb_entry hit;
+  uint seq, gen = asgen_of(pid);
+  int way;
+
+  pushcli();                       // 조회 동안 CPU 고정 (락 아님)
+  c = &stlbs[cpuid()];
+  s = &c->set[stlb_idx(pid, va_page)];
+  do {
+    while((seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE)) & 1)
+      ;
+    way = -1;
+    for(int w=0; w<STLB_WAYS; w++)
+      if(s->e[w].pid==pid && s->e[w].va_page==va_page && s->e[w].flags &&
+         s->e[w].gen==gen){
+        hit = s->e[w];
+        way = w;
+        break;
+      }
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  } while(__atomic_load_n(&s->seq, __ATOMIC_RELAXED) != seq);
+
+  struct stlb_pidstat *ps = stlb_pidslot(pid);
+  if(way < 0){
+    if(count){
+      c->misses++;
+      ps->misses++;
+    }
+    if(s->ghost.pid == pid && s->ghost.va_page == va_page && s->ghost.gen == gen){
+      c->cmisses++;
+      ps->cmisses++;
+    }
+    popcli();
+    return 0;
+  }
+  plru_touch(s, way);              // 힌트일 뿐: 경합으로 틀려도 정확성엔 무관
+  if(count){
+    c->hits++;
+    ps->hits++;
+  }
+  popcli();
+  if(pa_page) *pa_page = hit.pa_page;
+  if(flags)   *flags   = hit.flags;
+  return 1;
 }
 
 int stlb_lookup(int pid, uint va_page, uint *pa_page, uint *flags){
-  acquire(&stlblk);
-  uint i = stlb_idx(pid, va_page);
-  if(stlb[i].pid==pid && stlb[i].va_page==va_page){
-    if(pa_page) *pa_page = stlb[i].pa_page;
-    if(flags)   *flags   = stlb[i].flags;
-    tlb_hits++;
-    release(&stlblk);
-    return 1;
-  }
-  tlb_misses++;
-  release(&stlblk);
-  return 0;
+  return stlb_probe(pid, va_page, pa_page, flags, 1);
 }
 
+// 유저 복사 경로 통계: STLB로 걷기를 건너뛰었으면 uhits, 페이지 테이블을 걸었으면 uwalks
+static void stlb_ucount(int hit){
+  pushcli();
+  if(hit) stlbs[cpuid()].uhits++;
+  else    stlbs[cpuid()].uwalks++;
+  popcli();
+}
+
+// 자기 CPU 테이블에 채운다. 같은 키 → 빈(또는 옛 세대) way → 없으면 PLRU 희생.
 void stlb_fill(int pid, uint va_page, uint pa_page, uint flags){
-  acquire(&stlblk);
-  uint i = stlb_idx(pid, va_page);
-  stlb[i].pid = pid; stlb[i].va_page = va_page;
-  stlb[i].pa_page = pa_page; stlb[i].flags = flags;
-  release(&stlblk);
+  struct stlb_cpu *c;
+  struct stlb_set *s;
+  int w, way = -1;
+
+  pushcli();
+  c = &stlbs[cpuid()];
+  s = &c->set[stlb_idx(pid, va_page)];
+  acquire(&c->lock);
+  for(w=0; w<STLB_WAYS; w++)
+    if(s->e[w].pid==pid && s->e[w].va_page==va_page){ way = w; break; }
+  if(way < 0)
+    for(w=0; w<STLB_WAYS; w++)
+      if(!stlb_live(&s->e[w])){ way = w; break; }
+  if(way < 0){
+    way = plru_victim(s);
+    c->conflicts++;
+    s->ghost = s->e[way];
+    struct stlb_pidstat *vp = &stlbpid[s->e[way].pid & (ASGEN_SIZE-1)];
+    if(vp->pid == s->e[way].pid)
+      __atomic_add_fetch(&vp->evicts, 1, __ATOMIC_RELAXED);
+  }
+  set_write_begin(s);
+  s->e[way].pid = pid; s->e[way].va_page = va_page;
+  s->e[way].pa_page = pa_page; s->e[way].flags = flags | PTE_P;   // flags==0은 빈 칸 표시
+  s->e[way].gen = asgen_of(pid);
+  set_write_end(s);
+  plru_touch(s, way);
+  release(&c->lock);
+  popcli();
 }
 
 void stlb_stats(uint *hits, uint *misses){
-  acquire(&stlblk);
-  if(hits)   *hits   = tlb_hits;
-  if(misses) *misses = tlb_misses;
-  release(&stlblk);
+  uint h = 0, m = 0;
+  for(int c=0;c<ncpu;c++){
+    h += stlbs[c].hits;
+    m += stlbs[c].misses;
+  }
+  if(hits)   *hits   = h;
+  if(misses) *misses = m;
 }
 
-void stlb_invalidate_va(int pid, uint va_page){
-  acquire(&stlblk);
-  uint i = stlb_idx(pid, va_page);
-  if(stlb[i].pid==pid && stlb[i].va_page==va_page){
-    stlb[i].pid=0; stlb[i].va_page=0; stlb[i].pa_page=0; stlb[i].flags=0;
+// CPU별 통계 (tlbstat 기본 출력, stlbinfo)
+int stlb_cpustats(struct stlbstat *out, int max){
+  int n = ncpu < max ? ncpu : max;
+  for(int c=0;c<n;c++){
+    out[c].hits      = stlbs[c].hits;
+    out[c].misses    = stlbs[c].misses;
+    out[c].conflicts = stlbs[c].conflicts;
+    out[c].invals    = stlbs[c].invals;
+    out[c].uhits     = stlbs[c].uhits;
+    out[c].uwalks    = stlbs[c].uwalks;
+    out[c].cmisses   = stlbs[c].cmisses;
+  }
+  return n;
+}
+
+// pid 하나의 통계 (tlbstat -p). conflicts 칸에는 그 pid 엔트리가 밀려난 횟수.
+// 칸이 다른 pid 것이면(기록 없음) -1.
+int stlb_pidstats(int pid, struct stlbstat *out){
+  struct stlb_pidstat *p = &stlbpid[(uint)pid & (ASGEN_SIZE-1)];
+  memset(out, 0, sizeof(*out));
+  if(p->pid != pid)
+    return -1;
+  out->hits      = p->hits;
+  out->misses    = p->misses;
+  out->conflicts = p->evicts;
+  out->cmisses   = p->cmisses;
+  return 0;
+}
+
+// 모든 CPU에서 (pid, [va_lo, va_lo+len))에 드는 엔트리를 지우거나(newflags==0)
+// flags만 바꾼다. set: 검사할 세트 (-1이면 전부)
+static void
+stlb_shootdown(int set, int pid, uint va_lo, uint len, uint newflags)
+{
+  for(int c=0;c<ncpu;c++){
+    struct stlb_cpu *sc = &stlbs[c];
+    int lo = set < 0 ? 0 : set, hi = set < 0 ? STLB_SETS : set + 1;
+    acquire(&sc->lock);
+    for(int i=lo;i<hi;i++){
+      struct stlb_set *s = &sc->set[i];
+      for(int w=0; w<STLB_WAYS; w++){
+        struct stlb_entry *e = &s->e[w];
+        if(!stlb_live(e) || e->pid != pid || e->va_page - va_lo >= len)
+          continue;
+        set_write_begin(s);
+        if(newflags){
+          e->flags = newflags | PTE_P;
+        } else {
+          e->pid = 0; e->va_page = 0; e->pa_page = 0; e->flags = 0;
+          sc->invals++;
+        }
+        set_write_end(s);
+      }
+    }
+    release(&sc->lock);
   }
-  release(&stlblk);
+}
+
+void stlb_invalidate_va(int pid, uint va_page){
+  stlb_shootdown(stlb_idx(pid, va_page), pid, va_page, 1, 0);
 }
 
 void stlb_update_flags(int pid, uint va_page, uint newflags){
-  acquire(&stlblk);
-  uint i = stlb_idx(pid, va_page);
-  if(stlb[i].pid==pid && stlb[i].va_page==va_page)
-    stlb[i].flags = newflags;
-  release(&stlblk);
+  stlb_shootdown(stlb_idx(pid, va_page), pid, va_page, 1, newflags);
 }
 
+// 프로세스 전체 무효화 (exit/exec): 세대만 올린다. 모든 CPU의 엔트리가 한 번에 낡은 것이 된다.
 void stlb_purge_pid(int pid){
-  acquire(&stlblk);
-  for(int i=0;i<STLB_SIZE;i++)
-    if(stlb[i].pid==pid)
-      stlb[i].pid=0, stlb[i].va_page=0, stlb[i].pa_page=0, stlb[i].flags=0;
-  release(&stlblk);
+  __atomic_add_fetch(&asgen[(uint)pid & (ASGEN_SIZE-1)], 1, __ATOMIC_RELEASE);
+}
+
+// [va, va+len) 구간 무효화 (슈퍼페이지 해제/분할 시: 1024페이지).
+// 구간을 세트마다 뒤지는 것보다 그 pid 전체를 세대로 비우는 편이 싸다.
+void stlb_invalidate_range(int pid, uint va, uint len){
+  stlb_purge_pid(pid);
 }
 
 
 // ---------- (C) IPT: 해시 + 풀알로케이터 ----------
+// 엔트리는 두 리스트에 동시에 걸린다:
+//   pfn 버킷(ipt_hash)  - 역매핑 질의용
+//   pid 버킷(ipt_pidh)  - 프로세스 정리(purge)용, 그 pid의 엔트리 수만큼만 돈다
+// 둘 다 pprev(앞 노드의 next 주소)를 들고 있어 O(1)에 빠진다.
+//
+// 락: 전역 락 대신 줄무늬(stripe) 락.
+//   pfn 버킷은 IPT_STRIPES개 stripe가 나눠 맡고, stripe마다 spinlock + seq.
+//   쓰는 쪽은 lock을 잡고 seq를 홀수→짝수로 올리며 체인을 고친다.
+//   읽는 쪽(ipt_query)은 락 없이 체인을 따라가고 seq가 그대로일 때만 결과를 믿는다.
+//   계속 밀리면 그때만 lock을 잡는다. 즉 phys2virt가 COW/dealloc을 막지 않는다.
+//   pid 버킷은 IPT_PIDLOCKS개 락이 나눠 맡는다 (purge/insert/remove만 씀).
+//   순서: pfn stripe → pid 락. purge는 둘을 동시에 잡지 않는다.
+// 읽는 도중 엔트리가 해제·재사용될 수 있으므로 포인터는 커널 직접매핑 범위인지
+// 확인하고, 체인 길이도 제한한다(잘못 읽었으면 어차피 seq가 바뀌어 다시 읽는다).
 #define IPT_BUCKETS  8192
+#define IPT_PIDH     256
+#define IPT_STRIPES  128
+#define IPT_PIDLOCKS 16
+#define IPT_PURGE_BATCH 32   // purge 시 락 한 번에 떼어낼 엔트리 수
+#define IPT_READ_RETRY  4
+#define IPT_CHAIN_MAX   4096
 struct ipt_entry{
   uint pfn;       // 물리 프레임 번호
   uint pid;       // 소유 PID (-1: 커널)
   uint va;        // 페이지 기준 VA
   uint flags;     // PTE 권한 스냅샷
   uint refcnt;    // (옵션)
-  struct ipt_entry *next;
+  struct ipt_entry *next, **pprev;     // pfn 버킷
+  struct ipt_entry *pnext, **ppprev;   // pid 버킷 (0: purge가 떼어 감)
 };
 
 static struct ipt_entry *ipt_hash[IPT_BUCKETS];
-static struct spinlock iptlk;
+static struct ipt_entry *ipt_pidh[IPT_PIDH];
+
+static struct ipt_stripe {
+  struct spinlock lock;
+  uint seq;                        // 홀수: 수정 중
+} __attribute__((aligned(64))) ipt_stripes[IPT_STRIPES];
+
+static struct spinlock ipt_pidlk[IPT_PIDLOCKS];
+
+// 관측용 (iptstat): 엔트리 수/최대치/삽입 실패, CPU별 락 대기 사이클
+static uint ipt_nent, ipt_hiwat, ipt_drops;
+static struct {
+  uint acq, cont;                  // 획득 수, 그중 이미 잡혀 있던 수
+  uint64 wait, max;                // 대기 사이클 합/최대
+} __attribute__((aligned(64))) ipt_lkstat[NCPU];
+
+// IPT 락은 모두 여기로 잡는다: 대기 시간을 잰다 (잡힌 뒤엔 pushcli 상태라 cpuid 안전)
+static void ipt_lock(struct spinlock *lk){
+  int busy = lk->locked;
+  uint64 t0 = rdtsc(), dt;
+  acquire(lk);
+  dt = rdtsc() - t0;
+  if(lapic){
+    int c = cpuid();
+    ipt_lkstat[c].acq++;
+    if(busy) ipt_lkstat[c].cont++;
+    ipt_lkstat[c].wait += dt;
+    if(dt > ipt_lkstat[c].max) ipt_lkstat[c].max = dt;
+  }
+}
 
-#define IPT_POOL_SIZE  65536
-static struct ipt_entry ipt_pool[IPT_POOL_SIZE];
-static struct ipt_entry *ipt_free;
+// 엔트리는 슬랩 캐시에서 (고정 풀 대신: 쓰는 만큼만 페이지를 차지)
+static struct kmem_cache *ipt_cache;
 
 static inline uint ipt_h(uint pfn){ return pfn & (IPT_BUCKETS-1); }
+static inline uint ipt_ph(uint pid){ return pid & (IPT_PIDH-1); }
+static inline struct ipt_stripe* ipt_st(uint pfn){
+  return &ipt_stripes[ipt_h(pfn) & (IPT_STRIPES-1)];
+}
+static inline struct spinlock* ipt_plk(uint pid){
+  return &ipt_pidlk[ipt_ph(pid) & (IPT_PIDLOCKS-1)];
+}
+
+static void ipt_wlock(struct ipt_stripe *st){
+  ipt_lock(&st->lock);
+  __atomic_store_n(&st->seq, st->seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+static void ipt_wunlock(struct ipt_stripe *st){
+  __atomic_store_n(&st->seq, st->seq + 1, __ATOMIC_RELEASE);
+  release(&st->lock);
+}
+
+// pfn 버킷 stripe 쓰기 락 보유 상태에서 호출
+static void ipt_link_pfn(struct ipt_entry *e){
+  struct ipt_entry **h = &ipt_hash[ipt_h(e->pfn)];
+  if((e->next = *h) != 0) e->next->pprev = &e->next;
+  e->pprev = h;
+  __atomic_store_n(h, e, __ATOMIC_RELEASE);
+}
+static void ipt_unlink_pfn(struct ipt_entry *e){
+  if(e->next) e->next->pprev = e->pprev;
+  __atomic_store_n(e->pprev, e->next, __ATOMIC_RELEASE);
+}
+
+// pid 락 보유 상태에서 호출
+static void ipt_link_pid(struct ipt_entry *e){
+  struct ipt_entry **h = &ipt_pidh[ipt_ph(e->pid)];
+  if((e->pnext = *h) != 0) e->pnext->ppprev = &e->pnext;
+  *h = e; e->ppprev = h;
+}
+static void ipt_unlink_pid(struct ipt_entry *e){
+  if((*e->ppprev = e->pnext) != 0) e->pnext->ppprev = e->ppprev;
+  e->ppprev = 0;
+}
 
 static int ipt_ready = 0;   // mpinit() 이후 ipt_init()이 켜줌
 
 void ipt_init(void){
-  initlock(&iptlk, "ipt");
   memset(ipt_hash, 0, sizeof(ipt_hash));
-  for(int i=0;i<IPT_POOL_SIZE-1;i++) ipt_pool[i].next = &ipt_pool[i+1];
-  ipt_pool[IPT_POOL_SIZE-1].next = 0;
-  ipt_free = &ipt_pool[0];
+  memset(ipt_pidh, 0, sizeof(ipt_pidh));
+  for(int i = 0; i < IPT_STRIPES; i++){
+    initlock(&ipt_stripes[i].lock, "ipt");
+    ipt_stripes[i].seq = 0;
+  }
+  for(int i = 0; i < IPT_PIDLOCKS; i++)
+    initlock(&ipt_pidlk[i], "iptpid");
+  ipt_cache = kmem_cache_create("ipt", sizeof(struct ipt_entry), PF_T_IPT);
   ipt_ready = 1;                   // 여기서 활성화
 }
 
 static struct ipt_entry* ipt_alloc_ent(void){
-  if(!ipt_free) return 0;
-  struct ipt_entry *e = ipt_free;
-  ipt_free = e->next;
+  struct ipt_entry *e = (struct ipt_entry*)kmem_cache_alloc(ipt_cache);
+  if(e == 0){
+    __atomic_add_fetch(&ipt_drops, 1, __ATOMIC_RELAXED);
+    return 0;
+  }
+  uint n = __atomic_add_fetch(&ipt_nent, 1, __ATOMIC_RELAXED);
+  if(n > ipt_hiwat) ipt_hiwat = n;   // 경합 시 조금 덜 잡혀도 통계라 무방
   return e;
 }
 
 static void ipt_free_ent(struct ipt_entry *e){
-  e->next = ipt_free; ipt_free = e;
+  __atomic_sub_fetch(&ipt_nent, 1, __ATOMIC_RELAXED);
+  kmem_cache_free(ipt_cache, e);
 }
 
 void ipt_insert(uint pfn, int pid, uint va_page, uint flags){
   if(!ipt_ready) return;           // 부팅 초기에는 그냥 스킵
-  acquire(&iptlk);
-  struct ipt_entry *e = ipt_alloc_ent();
-  if(e){
-    e->pfn=pfn; e->pid=pid; e->va=va_page; e->flags=flags; e->refcnt=1;
-    uint b = ipt_h(pfn);
-    e->next = ipt_hash[b];
-    ipt_hash[b] = e;
-  }
-  release(&iptlk);
+  struct ipt_entry *e = ipt_alloc_ent();   // 슬랩은 자기 락을 쓰므로 IPT 락 밖에서
+  if(e == 0) return;
+  e->pfn=pfn; e->pid=pid; e->va=va_page; e->flags=flags; e->refcnt=1;
+  struct ipt_stripe *st = ipt_st(pfn);
+  ipt_wlock(st);
+  ipt_lock(ipt_plk(pid));
+  ipt_link_pid(e);
+  release(ipt_plk(pid));
+  ipt_link_pfn(e);
+  ipt_wunlock(st);
 }
 
 // --- vm.c: IPT에서 (pid, va_page, pfn) 하나 제거 ---
 //   PTE/물리프레임은 절대 건드리지 않는다(프레임 해제는 deallocuvm가 담당).
 //   va_page는 반드시 PGROUNDDOWN 한 값으로 비교.
+//   purge가 이미 떼어 간 엔트리(ppprev == 0)는 purge 몫이므로 없는 것으로 본다.
 int
 ipt_remove(int pid, uint va_page, uint pfn)
 {
@@ -182,47 +538,249 @@ ipt_remove(int pid, uint va_page, uint pfn)
 
   va_page = PGROUNDDOWN(va_page);
 
-  int removed = 0;
-  acquire(&iptlk);
-
-  uint b = ipt_h(pfn);
-  struct ipt_entry **pp = &ipt_hash[b], *cur;
-
-  while ((cur = *pp)) {
-    if (cur->pid == pid && cur->va == va_page && cur->pfn == pfn) {
-      *pp = cur->next;          // unlink
-      //  엔트리 메타만 free (물리 프레임 kfree 절대 금지)
-      ipt_free_ent(cur);
-      removed = 1;
+  struct ipt_stripe *st = ipt_st(pfn);
+  struct ipt_entry *cur;
+  ipt_wlock(st);
+  for (cur = ipt_hash[ipt_h(pfn)]; cur; cur = cur->next) {
+    if (cur->pid != pid || cur->va != va_page || cur->pfn != pfn)
+      continue;
+    ipt_lock(ipt_plk(pid));
+    int mine = cur->ppprev != 0;
+    if (mine)
+      ipt_unlink_pid(cur);
+    release(ipt_plk(pid));
+    if (mine) {
+      ipt_unlink_pfn(cur);
       break;
     }
-    pp = &cur->next;
   }
+  ipt_wunlock(st);
+  //  엔트리 메타만 free (물리 프레임 kfree 절대 금지)
+  if (cur)
+    ipt_free_ent(cur);
+  return cur != 0;
+}
 
-  release(&iptlk);
-  return removed;
+static inline int ipt_ptr_ok(struct ipt_entry *e){
+  return (uint)e >= KERNBASE && ((uint)e & 3) == 0 &&
+         (uint)e + sizeof(*e) <= (uint)P2V(PHYSTOP);
 }
 
+// 버킷 b에서 pfn이 want인 엔트리를 kbuf에 담는다 (ps: PTE_PS 엔트리만, va에 off 더함).
+// 체인이 이상하면(해제 중인 엔트리를 밟음) -1.
+static int
+ipt_scan(uint b, uint want, int ps, uint off, struct vref *kbuf, int max)
+{
+  struct ipt_entry *e = __atomic_load_n(&ipt_hash[b], __ATOMIC_ACQUIRE);
+  int n = 0, steps = 0;
+
+  for (; e && n < max; e = __atomic_load_n(&e->next, __ATOMIC_RELAXED)) {
+    if (!ipt_ptr_ok(e) || ++steps > IPT_CHAIN_MAX)
+      return -1;
+    if (e->pfn != want || (ps && !(e->flags & PTE_PS)))
+      continue;
+    kbuf[n].pid = e->pid;
+    kbuf[n].va  = e->va + off;
+    kbuf[n].flags = e->flags;
+    n++;
+  }
+  return n;
+}
+
+// 버킷 하나를 seqlock으로 읽는다. IPT_READ_RETRY번 밀리면 stripe 락을 잡는다.
+static int
+ipt_read(uint want, int ps, uint off, struct vref *kbuf, int max)
+{
+  struct ipt_stripe *st = ipt_st(want);
+  uint seq;
+  int n;
+
+  for (int t = 0; t < IPT_READ_RETRY; t++) {
+    while ((seq = __atomic_load_n(&st->seq, __ATOMIC_ACQUIRE)) & 1)
+      ;
+    n = ipt_scan(ipt_h(want), want, ps, off, kbuf, max);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&st->seq, __ATOMIC_RELAXED) == seq && n >= 0)
+      return n;
+  }
+  ipt_lock(&st->lock);
+  n = ipt_scan(ipt_h(want), want, ps, off, kbuf, max);
+  release(&st->lock);
+  return n < 0 ? 0 : n;
+}
+
+// 슈퍼페이지 매핑은 머리 프레임(pfn & ~(NPTENTRIES-1))에 PTE_PS 엔트리 하나로만
+// 기록되므로, 중간 프레임 질의 시 머리 버킷도 함께 보고 va를 오프셋만큼 보정한다.
 int ipt_query(uint pfn, struct vref *kbuf, int max){
   if(!ipt_ready) return 0;         // 준비 전이면 결과 없음
-  int n=0;
-  acquire(&iptlk);
+  uint head = pfn & ~(NPTENTRIES-1);
+  int n = ipt_read(pfn, 0, 0, kbuf, max);
+  if (head != pfn && n < max)
+    n += ipt_read(head, 1, (pfn - head) << 12, kbuf + n, max - n);
+  return n;
+}
+
+static inline uint ipt_bin(uint len){
+  uint b = 0;
+  if(len < 4) return len;          // 0, 1, 2, 3
+  for(b = 4, len >>= 3; len && b < IPT_HIST-1; len >>= 1)
+    b++;                           // 4-7, 8-15, 16-31, 32+
+  return b;
+}
+
+// 버킷 점유/체인 길이 분포와 락 통계 (iptstat). 체인은 ipt_read처럼 seqlock으로 세어
+// 쓰는 쪽을 막지 않는다. pid 버킷은 짧게 그 락을 잡고 센다.
+void
+ipt_stats(struct iptstat *out)
+{
   struct ipt_entry *e;
-  for (e = ipt_hash[ipt_h(pfn)]; e && n < max; e = e->next) {
-    if (e->pfn != pfn) continue;
-    kbuf[n].pid = e->pid;
-    kbuf[n].va  = e->va;
-    kbuf[n].flags = e->flags;
+  uint b, len, seq;
+  int t;
+
+  memset(out, 0, sizeof(*out));
+  out->nbuckets = IPT_BUCKETS;
+  out->npidbuckets = IPT_PIDH;
+  out->nent  = ipt_nent;
+  out->hiwat = ipt_hiwat;
+  out->drops = ipt_drops;
+  if(!ipt_ready) return;
+
+  for(b = 0; b < IPT_BUCKETS; b++){
+    struct ipt_stripe *st = &ipt_stripes[b & (IPT_STRIPES-1)];
+    for(t = 0; ; t++){
+      while((seq = __atomic_load_n(&st->seq, __ATOMIC_ACQUIRE)) & 1)
+        ;
+      len = 0;
+      for(e = __atomic_load_n(&ipt_hash[b], __ATOMIC_ACQUIRE);
+          e && ipt_ptr_ok(e) && len < IPT_CHAIN_MAX;
+          e = __atomic_load_n(&e->next, __ATOMIC_RELAXED))
+        len++;
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if(__atomic_load_n(&st->seq, __ATOMIC_RELAXED) == seq || t == IPT_READ_RETRY)
+        break;                     // 계속 밀리면 근삿값으로 만족
+    }
+    if(len) out->used++;
+    if(len > out->maxchain) out->maxchain = len;
+    out->hist[ipt_bin(len)]++;
+  }
+  for(b = 0; b < IPT_PIDH; b++){
+    struct spinlock *lk = &ipt_pidlk[b & (IPT_PIDLOCKS-1)];
+    len = 0;
+    ipt_lock(lk);
+    for(e = ipt_pidh[b]; e; e = e->pnext)
+      len++;
+    release(lk);
+    out->pidhist[ipt_bin(len)]++;
+  }
+  for(t = 0; t < ncpu; t++){
+    out->lkacq  += ipt_lkstat[t].acq;
+    out->lkcont += ipt_lkstat[t].cont;
+    out->lkwait += ipt_lkstat[t].wait;
+    if(ipt_lkstat[t].max > out->lkmax) out->lkmax = ipt_lkstat[t].max;
+  }
+}
+
+// 역매핑 순회용 버킷 읽기: ipt_scan과 같되 vref 버퍼 없이 out에 바로 쓴다.
+// pfn: 결과에 적을 프레임, want/ps/off: ipt_scan과 같음 (슈퍼페이지 머리 버킷용).
+// 유저 매핑만, pid >= 0이면 그 pid만. *k는 이 프레임에서 지금까지 맞은 매핑 수로,
+// skip개까지는 건너뛴다. out이 차서 남긴 매핑이 있으면 *more = 1. 체인이 이상하면 -1.
+static int
+ipt_rscan(uint pfn, uint want, int ps, uint off, int pid, uint skip, uint *k,
+          struct rmapent *out, int max, int *more)
+{
+  struct ipt_entry *e = __atomic_load_n(&ipt_hash[ipt_h(want)], __ATOMIC_ACQUIRE);
+  int n = 0, steps = 0;
+
+  for (; e; e = __atomic_load_n(&e->next, __ATOMIC_RELAXED)) {
+    if (!ipt_ptr_ok(e) || ++steps > IPT_CHAIN_MAX)
+      return -1;
+    if (e->pfn != want || (ps && !(e->flags & PTE_PS)))
+      continue;
+    if (!(e->flags & PTE_U) || (pid >= 0 && e->pid != (uint)pid))
+      continue;
+    if ((*k)++ < skip)
+      continue;
+    if (n == max) {
+      *more = 1;
+      break;
+    }
+    out[n].pfn = pfn;
+    out[n].pid = e->pid;
+    out[n].va = e->va + off;
+    out[n].flags = e->flags;
     n++;
   }
-  release(&iptlk);
+  return n;
+}
+
+// ipt_read처럼 seqlock으로 읽고, 다시 읽을 땐 *k/*more를 되돌린다.
+static int
+ipt_rread(uint pfn, uint want, int ps, uint off, int pid, uint skip, uint *k,
+          struct rmapent *out, int max, int *more)
+{
+  struct ipt_stripe *st = ipt_st(want);
+  uint seq, k0 = *k;
+  int n;
+
+  for (int t = 0; t < IPT_READ_RETRY; t++) {
+    while ((seq = __atomic_load_n(&st->seq, __ATOMIC_ACQUIRE)) & 1)
+      ;
+    *k = k0;
+    *more = 0;
+    n = ipt_rscan(pfn, want, ps, off, pid, skip, k, out, max, more);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&st->seq, __ATOMIC_RELAXED) == seq && n >= 0)
+      return n;
+  }
+  ipt_lock(&st->lock);
+  *k = k0;
+  *more = 0;
+  n = ipt_rscan(pfn, want, ps, off, pid, skip, k, out, max, more);
+  release(&st->lock);
+  return n < 0 ? 0 : n;
+}
+
+// 커서 c의 PFN부터 (pfn, pid, va, flags) 튜플을 out에 max개까지 채운다.
+// 매핑 수(pf_mapcnt)가 0인 프레임은 해시를 보지 않고 건너뛴다.
+// 해시 체인에서 out으로 바로 옮기므로 프레임당 매핑 수에 상한이 없다.
+// 한 프레임의 매핑이 다 안 들어가면 돌려준 개수를 c->skip에 적고 그 프레임에서 멈춘다.
+// 호출 사이에 매핑이 바뀌면 그 프레임은 빠지거나 겹칠 수 있다 (스냅샷 아님).
+int
+ipt_rmap(struct rmapcur *c, struct rmapent *out, int max)
+{
+  uint end = (c->end == 0 || c->end > pf_nframes) ? pf_nframes : c->end;
+  int n = 0, more;
+  uint k;
+
+  if(!ipt_ready) return 0;
+  while(c->start < end && n < max){
+    uint pfn = c->start;
+    uint head = pfn & ~(NPTENTRIES-1);
+    if(pf_mapget(pfn) == 0){
+      c->start++;
+      c->skip = 0;
+      continue;
+    }
+    k = 0;
+    n += ipt_rread(pfn, pfn, 0, 0, c->pid, c->skip, &k, out + n, max - n, &more);
+    if(!more && head != pfn)
+      n += ipt_rread(pfn, head, 1, (pfn - head) << 12, c->pid, c->skip, &k,
+                     out + n, max - n, &more);
+    if(more){
+      c->skip = k - 1;             // 못 담은 것 하나까지 센 상태
+      break;
+    }
+    c->start++;
+    c->skip = 0;
+  }
   return n;
 }
 
 int ipt_update_flags(int pid, uint va_page, uint pfn, uint newflags){
   if(!ipt_ready) return 0;
   int updated = 0;
-  acquire(&iptlk);
+  struct ipt_stripe *st = ipt_st(pfn);
+  ipt_wlock(st);
   struct ipt_entry *e;
     
   for (e = ipt_hash[ipt_h(pfn)]; e; e = e->next) {
@@ -232,37 +790,40 @@ int ipt_update_flags(int pid, uint va_page, uint pfn, uint newflags){
         break;
     }
   }
-  release(&iptlk);
+  ipt_wunlock(st);
   return updated;
 }
 
+// pid 버킷만 따라가며 IPT_PURGE_BATCH개씩 떼어내고(pid 락), 그 다음 엔트리마다
+// 자기 pfn stripe만 잠깐 잡아 빼낸 뒤 슬랩에 돌려준다.
+// 비용은 그 pid(와 같은 버킷을 쓰는 pid)의 매핑 수에 비례하고,
+// 어느 락도 purge 전체 동안 잡혀 있지 않다.
 void
 ipt_purge_pid(int pid)
 {
+  struct ipt_entry *batch[IPT_PURGE_BATCH], *e, *nx;
+  int n;
+
   if (!ipt_ready) return;
 
-  acquire(&iptlk);
-  for (int b = 0; b < IPT_BUCKETS; b++) {
-    struct ipt_entry **pp = &ipt_hash[b], *e;
-    while ((e = *pp)) {
-      if (e->pid == pid) {
-        *pp = e->next;       // unlink
-        ipt_free_ent(e);     //  메타만 free
-        continue;            //  다음 노드 검사(건너뛰기 방지)
-      }
-      pp = &e->next;
+  do {
+    n = 0;
+    ipt_lock(ipt_plk(pid));
+    for (e = ipt_pidh[ipt_ph(pid)]; e && n < IPT_PURGE_BATCH; e = nx) {
+      nx = e->pnext;
+      if (e->pid != pid) continue;
+      ipt_unlink_pid(e);
+      batch[n++] = e;
     }
-  }
-  release(&iptlk);
-}
-// pfn(= 물리 프레임 번호) 의 현재 IPT 참조 개수 반환
-int ipt_refcount(uint pfn) {
-  struct vref tmp[64];
-  int total = 0;
-  // ipt_query(pfn, buf, max) 는 최대 'max'개를 채워주고 실제 개수를 리턴한다고 가정
-  int n = ipt_query(pfn, tmp, 64);
-  if(n > 0) total += n;
-  return total;
+    release(ipt_plk(pid));
+    for (int i = 0; i < n; i++) {
+      struct ipt_stripe *st = ipt_st(batch[i]->pfn);
+      ipt_wlock(st);
+      ipt_unlink_pfn(batch[i]);
+      ipt_wunlock(st);
+      ipt_free_ent(batch[i]);      //  메타만 free
+    }
+  } while (n == IPT_PURGE_BATCH);
 }
 //----------------------------------------------------------------------
 
@@ -288,9 +849,103 @@ seginit(void)
   lgdt(c->gdt, sizeof(c->gdt));
 }
 
+// ---------- 공유 0 페이지 ----------
+// 읽기로 처음 건드린 익명 페이지(힙/bss)는 전역 0 프레임 하나를 RO+COW로 공유한다.
+// IPT에는 넣지 않고(수천 개 매핑이 한 버킷에 몰리지 않도록) 절대 kfree하지 않는다.
+uint zero_pa;
+
+static inline int is_zero_pa(uint pa){ return zero_pa && pa == zero_pa; }
+
+// pgdir 주인 pid: 페이지 테이블/유저 프레임을 myproc()이 아니라 이 주소공간 주인에게 단다
+static inline int pgdir_owner(pde_t *pgdir){ return pf_owner(V2P(pgdir) >> 12); }
+
+// ---------- (E) 4MB 슈퍼페이지 ----------
+// 매핑: PDE 하나 (PTE_PS), IPT에는 머리 프레임 기준 엔트리 하나.
+// 매핑 수(pf_mapcnt)는 1024 프레임 각각에 센다 (분할해도 그대로 유지되도록).
+// 4K 단위로 만져야 하는 경우(부분 COW/부분 해제 등)에는 spg_split()으로
+// 같은 프레임들을 가리키는 4K PTE 1024개짜리 페이지 테이블로 쪼갠다.
+
+static inline int is_spg(pde_t pde){
+  return (pde & (PTE_P|PTE_PS)) == (PTE_P|PTE_PS);
+}
+
+static inline void flush_if_cur(pde_t *pgdir){
+  struct proc *p = (lapic ? myproc() : 0);
+  if(p && p->pgdir == pgdir)
+    lcr3(V2P(pgdir));
+}
+
+// va(4MB 정렬)에 물리 연속 pa를 슈퍼페이지로 매핑
+static void
+spg_map(pde_t *pgdir, uint va, uint pa, int perm)
+{
+  pgdir[PDX(va)] = pa | perm | PTE_PS | PTE_P;
+  for(int i = 0; i < NPTENTRIES; i++)
+    pf_mapinc((pa >> 12) + i);
+  if(perm & PTE_U)
+    ipt_insert(pa >> 12, safe_curpid(), va, PTE_FLAGS(pgdir[PDX(va)]));
+}
+
+// va가 속한 슈퍼페이지를 4K 페이지 테이블로 분할. 프레임은 그대로 공유한다.
+static int
+spg_split(pde_t *pgdir, uint va)
+{
+  pde_t *pde = &pgdir[PDX(va)];
+  uint base  = PGADDR(PDX(va), 0, 0);
+  uint pa    = PTE_ADDR(*pde);
+  uint flags = PTE_FLAGS(*pde) & ~PTE_PS;
+  int pid    = safe_curpid();
+  pte_t *pgtab;
+
+  if((pgtab = (pte_t*)kalloc_type(PF_T_PGTBL, pgdir_owner(pgdir))) == 0)
+    return -1;
+  for(int i = 0; i < NPTENTRIES; i++)
+    pgtab[i] = (pa + i*PGSIZE) | flags;
+  *pde = V2P(pgtab) | PTE_P | PTE_W | PTE_U;
+
+  // IPT: 머리 엔트리 하나 → 4K 엔트리 1024개 (추적 중이던 매핑만)
+  if((flags & PTE_U) && ipt_remove(pid, base, pa >> 12))
+    for(int i = 0; i < NPTENTRIES; i++)
+      ipt_insert((pa >> 12) + i, pid, base + i*PGSIZE, flags);
+  stlb_invalidate_range(pid, base, SPGSIZE);
+  flush_if_cur(pgdir);
+  return 0;
+}
+
+// 슈퍼페이지의 모든 프레임을 이 매핑만 참조하는지
+static int
+spg_exclusive(uint head)
+{
+  for(int i = 0; i < NPTENTRIES; i++)
+    if(pf_mapget(head + i) > 1)
+      return 0;
+  return 1;
+}
+
+// 슈퍼페이지 전체 해제. 다른 매핑이 남아 있지 않은 프레임만 돌려준다.
+static void
+spg_unmap(pde_t *pgdir, uint va, int is_cur)
+{
+  pde_t *pde = &pgdir[PDX(va)];
+  uint base = PGADDR(PDX(va), 0, 0);
+  uint pa   = PTE_ADDR(*pde);
+  int pid   = safe_curpid();
+
+  *pde = 0;
+  if(is_cur){
+    lcr3(V2P(pgdir));
+    stlb_invalidate_range(pid, base, SPGSIZE);
+    ipt_remove(pid, base, pa >> 12);
+  }
+  for(int i = 0; i < NPTENTRIES; i++)
+    if(pf_mapdec((pa >> 12) + i) == 0)
+      kfree(P2V(pa + i*PGSIZE));
+}
+
 // Return the address of the PTE in page table pgdir
 // that corresponds to virtual address va.  If alloc!=0,
 // create any required page table pages.
+// 슈퍼페이지가 걸려 있으면 4K로 분할한 뒤 PTE를 돌려준다.
 static pte_t *
 walkpgdir(pde_t *pgdir, const void *va, int alloc)
 {
@@ -298,13 +953,14 @@ walkpgdir(pde_t *pgdir, const void *va, int alloc)
   pte_t *pgtab;
 
   pde = &pgdir[PDX(va)];
+  if(is_spg(*pde) && spg_split(pgdir, (uint)va) < 0)
+    return 0;
   if(*pde & PTE_P){
     pgtab = (pte_t*)P2V(PTE_ADDR(*pde));
   } else {
-    if(!alloc || (pgtab = (pte_t*)kalloc()) == 0)
+    // kzalloc: all those PTE_P bits are already zero.
+    if(!alloc || (pgtab = (pte_t*)kzalloc_type(PF_T_PGTBL, pgdir_owner(pgdir))) == 0)
       return 0;
-    // Make sure all those PTE_P bits are zero.
-    memset(pgtab, 0, PGSIZE);
     // The permissions here are overly generous, but they can
     // be further restricted by the permissions in the page table
     // entries, if necessary.
@@ -318,7 +974,7 @@ walkpgdir(pde_t *pgdir, const void *va, int alloc)
 // be page-aligned.
 
 // ---------- (D) vm.c의 기존 경로에 IPT/SoftTLB 연동 ----------
-// mappages(): 매핑 생성 시 IPT에 삽입
+// mappages(): 매핑 생성 시 IPT에 삽입, 유저 영역이면 프레임 매핑 수 +1
 int
 mappages(pde_t *pgdir, void *va, uint size, uint pa, int perm)
 {
@@ -332,6 +988,8 @@ mappages(pde_t *pgdir, void *va, uint size, uint pa, int perm)
     if(*pte & PTE_P)
       panic("remap");
     *pte = pa | perm | PTE_P;
+    if((uint)a < KERNBASE)
+      pf_mapinc(pa >> 12);
 
 	// ---- IPT 삽입 (유저 매핑만) ----
 	uint flags   = PTE_FLAGS(*pte);
@@ -384,15 +1042,15 @@ static struct kmap {
 };
 
 // Set up kernel part of a page table.
+// pid: 이 주소공간의 주인 (pgdir/페이지 테이블 프레임의 소유자로 기록)
 pde_t*
-setupkvm(void)
+setupkvm_owner(int pid)
 {
   pde_t *pgdir;
   struct kmap *k;
 
-  if((pgdir = (pde_t*)kalloc()) == 0)
+  if((pgdir = (pde_t*)kzalloc_type(PF_T_PGDIR, pid)) == 0)
     return 0;
-  memset(pgdir, 0, PGSIZE);
   if (P2V(PHYSTOP) > (void*)DEVSPACE)
     panic("PHYSTOP too high");
   for(k = kmap; k < &kmap[NELEM(kmap)]; k++)
@@ -404,6 +1062,12 @@ setupkvm(void)
   return pgdir;
 }
 
+pde_t*
+setupkvm(void)
+{
+  return setupkvm_owner(safe_curpid());
+}
+
 // Allocate one page table for the machine for the kernel address
 // space for scheduler processes.
 void
@@ -419,6 +1083,7 @@ kvmalloc(void)
   if (!inited) {
     stlb_init();
     ipt_init();
+    zero_pa = V2P(kzalloc());
     pf_mark_ready();     //  이 시점 이후에만 kfree가 pf_reset 수행
     inited = 1;
   }
@@ -465,8 +1130,7 @@ inituvm(pde_t *pgdir, char *init, uint sz)
 
   if(sz >= PGSIZE)
     panic("inituvm: more than a page");
-  mem = kalloc();
-  memset(mem, 0, PGSIZE);
+  mem = kzalloc_type(PF_T_USER, pgdir_owner(pgdir));
   mappages(pgdir, 0, PGSIZE, V2P(mem), PTE_W|PTE_U);
   memmove(mem, init, sz);
 }
@@ -477,14 +1141,13 @@ int
 loaduvm(pde_t *pgdir, char *addr, struct inode *ip, uint offset, uint sz)
 {
   uint i, pa, n;
-  pte_t *pte;
 
   if((uint) addr % PGSIZE != 0)
     panic("loaduvm: addr must be page aligned");
   for(i = 0; i < sz; i += PGSIZE){
-    if((pte = walkpgdir(pgdir, addr+i, 0)) == 0)
+    // 읽기만 하므로 sw_vtop (슈퍼페이지를 쪼개지 않음)
+    if(sw_vtop(pgdir, addr+i, &pa, 0) < 0)
       panic("loaduvm: address should exist");
-    pa = PTE_ADDR(*pte);
     if(sz - i < PGSIZE)
       n = sz - i;
     else
@@ -510,13 +1173,20 @@ allocuvm(pde_t *pgdir, uint oldsz, uint newsz)
 
   a = PGROUNDUP(oldsz);
   for(; a < newsz; a += PGSIZE){
-    mem = kalloc();
+    // 4MB 정렬 구간이 통째로 들어가면 연속 프레임을 받아 슈퍼페이지로
+    if(a % SPGSIZE == 0 && newsz - a >= SPGSIZE && !(pgdir[PDX(a)] & PTE_P) &&
+       (mem = kalloc_order(SPGORDER, PF_T_USER, pgdir_owner(pgdir))) != 0){
+      memset(mem, 0, SPGSIZE);
+      spg_map(pgdir, a, V2P(mem), PTE_W|PTE_U);
+      a += SPGSIZE - PGSIZE;
+      continue;
+    }
+    mem = kzalloc_type(PF_T_USER, pgdir_owner(pgdir));   // 미리 0으로 채워 둔 풀에서 (memset 생략)
     if(mem == 0){
       cprintf("allocuvm out of memory\n");
       deallocuvm(pgdir, newsz, oldsz);
       return 0;
     }
-    memset(mem, 0, PGSIZE);
     if(mappages(pgdir, (char*)a, PGSIZE, V2P(mem), PTE_W|PTE_U) < 0){
       cprintf("allocuvm out of memory (2)\n");
       deallocuvm(pgdir, newsz, oldsz);
@@ -541,8 +1211,21 @@ deallocuvm(pde_t *pgdir, uint oldsz, uint newsz)
   if (newsz >= oldsz)
     return oldsz;
 
+  // 현재 주소공간에서 많이 걷어낼 땐 STLB를 페이지마다 쏘지 말고 세대 한 번으로 비운다
+  int bulk = (myproc() && myproc()->pgdir == pgdir &&
+              oldsz - newsz > STLB_WAYS * PGSIZE);
+  if (bulk)
+    stlb_purge_pid(safe_curpid());
+
   a = PGROUNDUP(newsz);
   for (; a < oldsz; a += PGSIZE) {
+    // 슈퍼페이지가 통째로 범위 안이면 한 번에 해제 (일부만이면 walkpgdir가 분할)
+    pde_t pde = pgdir[PDX(a)];
+    if (is_spg(pde) && a % SPGSIZE == 0 && oldsz - a >= SPGSIZE) {
+      spg_unmap(pgdir, a, myproc() && myproc()->pgdir == pgdir);
+      a += SPGSIZE - PGSIZE;
+      continue;
+    }
     pte = walkpgdir(pgdir, (char*)a, 0);
     if (!pte) { a = PGADDR(PDX(a)+1,0,0) - PGSIZE; continue; }
     if ((*pte & PTE_P) == 0) continue;
@@ -550,6 +1233,13 @@ deallocuvm(pde_t *pgdir, uint oldsz, uint newsz)
     pa = PTE_ADDR(*pte);
     if (pa == 0) panic("deallocuvm kfree");
 
+    if (is_zero_pa(pa)) {               // 공유 0 페이지: 매핑만 걷어낸다
+      *pte = 0;
+      if (myproc() && myproc()->pgdir == pgdir && !bulk)
+        stlb_invalidate_va(safe_curpid(), PGROUNDDOWN(a));
+      continue;
+    }
+
     uint va_page = PGROUNDDOWN(a);
     uint pfn     = pa >> 12;
 
@@ -563,15 +1253,15 @@ deallocuvm(pde_t *pgdir, uint oldsz, uint newsz)
     // 2) 현재 주소공간일 때만 HW TLB flush 및 STLB/IPT 조작
     if (is_cur_pgdir) {
       lcr3(V2P(pgdir));                   // HW TLB flush
-      stlb_invalidate_va(pid_cur, va_page);
+      if (!bulk)
+        stlb_invalidate_va(pid_cur, va_page);
       ipt_remove(pid_cur, va_page, pfn);  //  부모가 자식 pgdir을 free할 땐 실행하지 않음
     }
 
-    // 3) 남은 레퍼런스가 없을 때만 프레임 해제
-    if (ipt_refcount(pfn) == 0) {
-      pf_reset(pfn);                      // no-op이면 무시
+    // 3) 남은 매핑이 없을 때만 프레임 해제 (pid/현재 주소공간과 무관하게 PTE 수로 판단)
+    //    프레임 테이블은 kfree(pf_release)가 비운다
+    if (pf_mapdec(pfn) == 0)
       kfree(P2V(pa));
-    }
   }
   return newsz;
 }
@@ -627,13 +1317,16 @@ copyuvm(pde_t *pgdir, uint sz)
   if((d = setupkvm()) == 0)
     return 0;
   for(i = 0; i < sz; i += PGSIZE){
-    if((pte = walkpgdir(pgdir, (void *) i, 0)) == 0)
-      panic("copyuvm: pte should exist");
+    // 지연 할당 구간은 PT/PTE가 없을 수 있다: cowuvm처럼 건너뛴다
+    if((pte = walkpgdir(pgdir, (void *) i, 0)) == 0){
+      i = PGADDR(PDX(i)+1, 0, 0) - PGSIZE;
+      continue;
+    }
     if(!(*pte & PTE_P))
-      panic("copyuvm: page not present");
+      continue;
     pa = PTE_ADDR(*pte);
     flags = PTE_FLAGS(*pte);
-    if((mem = kalloc()) == 0)
+    if((mem = kalloc_type(PF_T_USER, pgdir_owner(d))) == 0)
       goto bad;
     memmove(mem, (char*)P2V(pa), PGSIZE);
     if(mappages(d, (void*)i, PGSIZE, V2P(mem), flags) < 0) {
@@ -662,6 +1355,14 @@ cow_share_page(pde_t *pgdir_parent, pde_t *pgdir_child, uint va, int child_pid)
   uint va_page = PGROUNDDOWN(va);
   uint pfn     = pa >> 12;
 
+  // 0 페이지는 이미 RO+COW: PTE만 그대로 복사 (IPT 없음)
+  if(is_zero_pa(pa)){
+    pte_t *zpte = walkpgdir(pgdir_child, (char*)va_page, 1);
+    if(zpte == 0) return -1;
+    *zpte = *ppte;
+    return 0;
+  }
+
   // 1) 부모 PTE를 RO + COW로
   uint cow_flags = (flags & ~PTE_W) | PTE_COW;
   *ppte = pa | cow_flags;
@@ -681,6 +1382,7 @@ cow_share_page(pde_t *pgdir_parent, pde_t *pgdir_child, uint va, int child_pid)
   pte_t *cpte = walkpgdir(pgdir_child, (char*)va_page, 1);  // 필요 시 PT 생성
   if(cpte == 0) return -1;
   *cpte = pa | cow_flags;                      // 동일 PFN, RO+COW
+  pf_mapinc(pfn);
 
   // 4) IPT: 자식쪽 삽입
   ipt_insert(pfn, child_pid, va_page, cow_flags);
@@ -693,14 +1395,39 @@ pde_t*
 cowuvm(pde_t *pgdir_parent, uint sz, int child_pid)
 {
   pde_t *d;
-  if((d = setupkvm()) == 0)
+  if((d = setupkvm_owner(child_pid)) == 0)
     return 0;
 
   for(uint va = 0; va < sz; va += PGSIZE){
+    pde_t *pde = &pgdir_parent[PDX(va)];
+    if(is_spg(*pde) && (*pde & PTE_U)){
+      // 슈퍼페이지는 PDE째로 공유 (양쪽 RO+COW, IPT 머리 엔트리)
+      uint cow = (PTE_FLAGS(*pde) & ~PTE_W) | PTE_COW;
+      uint pa  = PTE_ADDR(*pde);
+      *pde = pa | cow;
+      d[PDX(va)] = pa | cow;
+      for(int i = 0; i < NPTENTRIES; i++)
+        pf_mapinc((pa >> 12) + i);
+      int ppid = safe_curpid();
+      stlb_invalidate_range(ppid, va, SPGSIZE);
+      if(ipt_update_flags(ppid, va, pa >> 12, cow) == 0)
+        ipt_insert(pa >> 12, ppid, va, cow);
+      ipt_insert(pa >> 12, child_pid, va, cow);
+      va += SPGSIZE - PGSIZE;
+      continue;
+    }
     pte_t *pte = walkpgdir(pgdir_parent, (char*)va, 0);
     if(pte == 0) { va = PGADDR(PDX(va)+1, 0, 0) - PGSIZE; continue; }
     if((*pte & PTE_P) == 0) continue;           // unmapped
-    if((*pte & PTE_U) == 0) continue;           // 커널 전용은 공유 대상 아님
+    if((*pte & PTE_U) == 0){
+      // 스택 가드 페이지: PTE째로 복사해 둔다. 비워 두면 sz 안의 not-present
+      // 폴트가 되어 lazy_fault가 새 페이지를 붙여 버린다
+      pte_t *cpte = walkpgdir(d, (char*)va, 1);
+      if(cpte == 0){ freevm(d); return 0; }
+      *cpte = *pte;
+      pf_mapinc(PTE_ADDR(*pte) >> 12);
+      continue;
+    }
     if(cow_share_page(pgdir_parent, d, va, child_pid) < 0){ freevm(d); return 0; }
   }
   // 부모의 TLB를 한번에 싹 비움(부모 PTE가 바뀌었기 때문)
@@ -713,26 +1440,61 @@ int cow_fault(pde_t *pgdir, uint va)
 {
   uint va_page = PGROUNDDOWN(va);
 
+  pde_t *pde = &pgdir[PDX(va_page)];
+  if(is_spg(*pde)){
+    if((*pde & PTE_COW) == 0) return -1;
+    uint base = PGADDR(PDX(va_page), 0, 0);
+    uint head = PTE_ADDR(*pde) >> 12;
+    if(spg_exclusive(head)){
+      // 나눠 쓰던 쪽이 모두 떠났으면 복사 없이 쓰기 권한만 복구
+      int pid = safe_curpid();
+      *pde = (*pde | PTE_W) & ~PTE_COW;
+      ipt_update_flags(pid, base, head, PTE_FLAGS(*pde));
+      stlb_invalidate_range(pid, base, SPGSIZE);
+      lcr3(V2P(pgdir));
+      return 0;
+    }
+    // 공유 중: 4K로 쪼갠 뒤 해당 페이지만 아래에서 복사
+  }
+
   pte_t *pte = walkpgdir(pgdir, (char*)va_page, 0);
   if(!pte || (*pte & PTE_P) == 0) return -1;
   if((*pte & PTE_COW) == 0) return -1;
 
   uint old_pa   = PTE_ADDR(*pte);
   uint old_flag = PTE_FLAGS(*pte);
+  int pid = safe_curpid();
 
-  char *mem = kalloc();
-  if(mem == 0) return -1;
-  memmove(mem, (char*)P2V(old_pa), PGSIZE);
+  // 나눠 쓰던 쪽이 모두 떠났으면 복사 없이 쓰기 권한만 복구
+  if(!is_zero_pa(old_pa) && pf_mapget(old_pa >> 12) == 1){
+    *pte = (*pte | PTE_W) & ~PTE_COW;
+    ipt_update_flags(pid, va_page, old_pa >> 12, PTE_FLAGS(*pte));
+    stlb_invalidate_va(pid, va_page);
+    lcr3(V2P(pgdir));
+    return 0;
+  }
 
-  int pid = safe_curpid();
+  char *mem;
+  if(is_zero_pa(old_pa)){
+    // 0 페이지에 첫 쓰기: 복사 대신 미리 0으로 채운 프레임
+    if((mem = kzalloc_type(PF_T_USER, pgdir_owner(pgdir))) == 0) return -1;
+  } else {
+    if((mem = kalloc_type(PF_T_USER, pgdir_owner(pgdir))) == 0) return -1;
+    memmove(mem, (char*)P2V(old_pa), PGSIZE);
+  }
 
-  // STLB/ipt에서 기존 매핑 제거
+  // STLB/ipt에서 기존 매핑 제거 (0 페이지는 IPT에 없음)
   stlb_invalidate_va(pid, va_page);
-  ipt_remove(pid, va_page, old_pa >> 12);
+  if(!is_zero_pa(old_pa))
+    ipt_remove(pid, va_page, old_pa >> 12);
 
   // 새 페이지로 재매핑: 쓰기 가능, COW 해제
   *pte = V2P(mem) | ((old_flag | PTE_W) & ~PTE_COW);
   uint nflags = PTE_FLAGS(*pte);
+  pf_mapinc(V2P(mem) >> 12);
+  // 옛 프레임: 그 사이 다른 쪽이 모두 떠났다면 여기서 마지막 참조가 빠진다
+  if(!is_zero_pa(old_pa) && pf_mapdec(old_pa >> 12) == 0)
+    kfree(P2V(old_pa));
 
   // IPT에 새 프레임 삽입
   ipt_insert((V2P(mem) >> 12), pid, va_page, nflags);
@@ -742,36 +1504,97 @@ int cow_fault(pde_t *pgdir, uint va)
   return 0;
 }
 
+// 지연 할당(힙/bss) 페이지 폴트: va < sz 인데 매핑이 없으면 페이지를 붙인다.
+//   읽기: 공유 0 페이지를 RO+COW로 (쓰기 시 cow_fault가 전용 프레임으로 교체)
+//   쓰기: 0으로 채운 4K 프레임. 건드린 페이지만 채운다 (슈퍼페이지는 allocuvm이
+//         미리 채우는 구간에서만 쓴다)
+int lazy_fault(pde_t *pgdir, uint va, uint sz, int write)
+{
+  uint va_page = PGROUNDDOWN(va);
+  pte_t *pte;
+  char *mem;
+
+  if(va >= sz || va >= KERNBASE) return -1;
+
+  if(!write && zero_pa){
+    if((pte = walkpgdir(pgdir, (char*)va_page, 1)) == 0) return -1;
+    if(*pte & PTE_P) return -1;
+    *pte = zero_pa | PTE_U | PTE_COW | PTE_P;
+    return 0;
+  }
+
+  pte = walkpgdir(pgdir, (char*)va_page, 0);
+  if(pte && (*pte & PTE_P)) return -1;         // 이미 매핑됨: 지연 할당 대상 아님
+  if((mem = kzalloc_type(PF_T_USER, pgdir_owner(pgdir))) == 0) return -1;
+  if(mappages(pgdir, (char*)va_page, PGSIZE, V2P(mem), PTE_W|PTE_U) < 0){
+    kfree(mem);
+    return -1;
+  }
+  return 0;
+}
+
+// copyout 미스 경로: 한 번 걸어 커널 주소와 PTE 플래그를 함께 얻는다 (유저 페이지만)
+static char*
+uva_walk(pde_t *pgdir, uint va0, uint *flags)
+{
+  uint pa;
+
+  if(sw_vtop(pgdir, (void*)va0, &pa, flags) < 0 || (*flags & PTE_U) == 0)
+    return 0;
+  return (char*)P2V(PGROUNDDOWN(pa));
+}
+
 //PAGEBREAK!
 // Map user virtual address to kernel address.
 char*
 uva2ka(pde_t *pgdir, char *uva)
 {
-  pte_t *pte;
+  uint pa, flags;
 
-  pte = walkpgdir(pgdir, uva, 0);
-  if((*pte & PTE_P) == 0)
+  // 슈퍼페이지를 쪼개지 않도록 sw_vtop으로 조회
+  if(sw_vtop(pgdir, uva, &pa, &flags) < 0)
     return 0;
-  if((*pte & PTE_U) == 0)
+  if((flags & PTE_U) == 0)
     return 0;
-  return (char*)P2V(PTE_ADDR(*pte));
+  return (char*)P2V(PGROUNDDOWN(pa));
 }
 
 // Copy len bytes from p to user address va in page table pgdir.
 // Most useful when pgdir is not the current page table.
-// uva2ka ensures this only works for PTE_U pages.
+// Only PTE_U pages are written (uva_walk checks, as uva2ka did).
+// 현재 주소공간이면 STLB로 변환을 캐시한다 (tlbstat의 ucopy 열).
 int
 copyout(pde_t *pgdir, uint va, void *p, uint len)
 {
   char *buf, *pa0;
-  uint n, va0;
+  uint n, va0, pa, flags;
+  int cur = myproc() && myproc()->pgdir == pgdir;
+  int pid = cur ? myproc()->pid : -1;
 
   buf = (char*)p;
   while(len > 0){
     va0 = (uint)PGROUNDDOWN(va);
-    pa0 = uva2ka(pgdir, (char*)va0);
-    if(pa0 == 0)
-      return -1;
+    // 현재 주소공간이고 STLB에 쓰기 가능(COW 아님)으로 있으면 걷지 않는다
+    if(cur && stlb_probe(pid, va0, &pa, &flags, 0) &&
+       (flags & (PTE_U|PTE_W|PTE_COW)) == (PTE_U|PTE_W)){
+      pa0 = P2V(pa);
+      stlb_ucount(1);
+    } else {
+      pa0 = uva_walk(pgdir, va0, &flags);
+      if(pa0 == 0 && cur && lazy_fault(pgdir, va0, myproc()->sz, 1) == 0)
+        pa0 = uva_walk(pgdir, va0, &flags);  // 아직 안 붙은 힙 페이지
+      if(pa0 == 0)
+        return -1;
+      // 커널 매핑으로 쓰면 COW(공유 0 페이지 포함)를 우회하므로 먼저 떼어낸다
+      if(cur && (flags & PTE_COW)){
+        if(cow_fault(pgdir, va0) < 0 || (pa0 = uva_walk(pgdir, va0, &flags)) == 0)
+          return -1;
+      }
+      if(cur){
+        stlb_fill(pid, va0, V2P(pa0), flags);
+        stlb_ucount(0);
+      }
+    }
     n = PGSIZE - (va - va0);
     if(n > len)
       n = len;
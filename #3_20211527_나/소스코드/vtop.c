@@ -14,10 +14,28 @@ static uint parse_hex(const char *p){
 }
 
 static void usage(void){
-  printf(1,"usage: vtop <hex_va> | -s | -a N [-r M]\n");
+  printf(1,"usage: vtop <hex_va> [-r M] | -s [-r M] | -a N | -R <hex_va> N [-P]\n");
   exit();
 }
 
+// [va, va+pages) 를 vtop_range 한 번으로 받아 페이지마다 출력 (present: 매핑된 것만)
+static void range(uint va, int pages, int present){
+  struct vtopent *e = malloc(sizeof(struct vtopent) * pages);
+  int n = vtop_range((void*)va, pages, e, present ? VTR_PRESENT : 0);
+  if(n < 0){ printf(1,"vtop: vtop_range failed\n"); exit(); }
+  int mapped = 0;
+  for(int k=0;k<n;k++){
+    if(e[k].flags){
+      mapped++;
+      printf(1,"VA=0x%x -> PA=0x%x flags=0x%x\n", e[k].va, e[k].pa, e[k].flags);
+    } else {
+      printf(1,"VA=0x%x -> (not present)\n", e[k].va);
+    }
+  }
+  printf(1,"[vtop] %d pages from 0x%x: %d mapped\n", pages, va, mapped);
+  free(e);
+}
+
 int main(int argc, char **argv){
   uint va=0; int pages=0, repeat=1; int i=1;
   if(argc<2) usage();
@@ -33,7 +51,14 @@ int main(int argc, char **argv){
     if(base==(char*)-1){ printf(1,"vtop: sbrk failed\n"); exit(); }
     for(int k=0;k<pages;k++) base[k*4096]=(char)k; // 실제 할당
     printf(1,"[vtop] base=0x%x pages=%d\n",(uint)base,pages);
-    va=(uint)base;
+    range((uint)base, pages, 0);   // 구간 전체를 vtop_range 한 번으로
+    exit();
+  } else if(!strcmp(argv[i],"-R")){
+    if(i+2>=argc) usage();
+    va=parse_hex(argv[i+1]);
+    pages=atoi(argv[i+2]); if(pages<=0) usage();
+    range(va, pages, i+3<argc && !strcmp(argv[i+3],"-P"));
+    exit();
   } else {
     va=parse_hex(argv[i]); i++;
   }